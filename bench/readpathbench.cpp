@@ -0,0 +1,341 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+// Microbenchmarks for the sysfs read path (monitor tick, refresh, parsing).
+// Every benchmark runs against an in-memory sysfs tree with 8, 64, 512 and
+// 4096 CPUs and reports ns/op plus heap allocations per op.
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "core/cpusettings.h"
+#include "core/dbushelper.h"
+#include "core/frequencysampler.h"
+#include "core/memorysysfsbackend.h"
+#include "core/procstatsampler.h"
+#include "core/sysfsreader.h"
+#include "models/cpulistmodel.h"
+#include "../helper/src/metricsrenderer.h"
+
+// ============================================================================
+// Allocation counting
+// ============================================================================
+
+static std::atomic<quint64> s_allocations{0};
+
+void *operator new(std::size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace {
+
+// Counts allocations made while the benchmark loop runs
+class AllocationCounter
+{
+public:
+    explicit AllocationCounter(benchmark::State &state)
+        : m_state(state)
+        , m_start(s_allocations.load(std::memory_order_relaxed))
+    {
+    }
+
+    ~AllocationCounter()
+    {
+        const quint64 count = s_allocations.load(std::memory_order_relaxed) - m_start;
+        m_state.counters["allocs/op"] =
+            benchmark::Counter(static_cast<double>(count), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State &m_state;
+    quint64 m_start;
+};
+
+// Simulated machine: a third of the CPUs offline so CPU lists contain ranges
+struct Machine {
+    explicit Machine(int cpus, int cpusPerPolicy = 1)
+    {
+        MemorySysfsBackend::Config config;
+        config.cpuCount = cpus;
+        config.cpusPerPolicy = cpusPerPolicy;
+        backend = std::make_unique<MemorySysfsBackend>(config);
+
+        for (int cpu = 1; cpu < cpus; cpu += 3) {
+            backend->setCpuOnline(cpu, false);
+        }
+
+        reader = std::make_unique<SysfsReader>(backend.get());
+    }
+
+    std::unique_ptr<MemorySysfsBackend> backend;
+    std::unique_ptr<SysfsReader> reader;
+};
+
+int cpuCount(const benchmark::State &state)
+{
+    return static_cast<int>(state.range(0));
+}
+
+} // namespace
+
+// ============================================================================
+// SysfsReader
+// ============================================================================
+
+static void BM_CurrentFreq(benchmark::State &state)
+{
+    Machine machine(cpuCount(state));
+    const int cpus = cpuCount(state);
+    int cpu = 0;
+
+    // Warm the descriptor cache like a running monitor has
+    for (int i = 0; i < cpus; ++i) {
+        machine.reader->currentFreq(i);
+    }
+
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(machine.reader->currentFreq(cpu));
+        cpu = cpu + 1 < cpus ? cpu + 1 : 0;
+    }
+}
+
+static void BM_AvailableCpus(benchmark::State &state)
+{
+    Machine machine(cpuCount(state));
+
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(machine.reader->availableCpus());
+    }
+}
+
+static void BM_ParseCpuList(benchmark::State &state)
+{
+    Machine machine(cpuCount(state));
+    const QString content = QString::fromLatin1(machine.backend->readAll(QStringLiteral("online"))).trimmed();
+
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(SysfsReader::parseCpuList(content));
+    }
+}
+
+static void BM_ParseList(benchmark::State &state)
+{
+    // One policy spanning the machine: related_cpus lists every CPU
+    Machine machine(cpuCount(state), cpuCount(state));
+    const QString content = QString::fromLatin1(
+        machine.backend->readAll(QStringLiteral("cpufreq/policy0/related_cpus")));
+
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(SysfsReader::parseList(content));
+    }
+}
+
+// ============================================================================
+// CpuSettings / CpuListModel
+// ============================================================================
+
+static void BM_UpdateFromSystem(benchmark::State &state)
+{
+    Machine machine(cpuCount(state));
+    DbusHelper dbus;
+    CpuListModel model(&dbus, machine.reader.get());
+    const int rows = model.rowCount();
+    int row = 0;
+
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        model.cpuAt(row)->updateFromSystem();
+        row = row + 1 < rows ? row + 1 : 0;
+    }
+}
+
+static void BM_RefreshAll(benchmark::State &state)
+{
+    Machine machine(cpuCount(state));
+    DbusHelper dbus;
+    CpuListModel model(&dbus, machine.reader.get());
+
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        model.refreshAll();
+    }
+    state.SetItemsProcessed(state.iterations() * model.rowCount());
+}
+
+static void BM_SetCurrentFrequencies(benchmark::State &state)
+{
+    Machine machine(cpuCount(state));
+    DbusHelper dbus;
+    CpuListModel model(&dbus, machine.reader.get());
+
+    // Two samples that move every third row, so each tick publishes a change
+    QList<int> samples[2];
+    for (int row = 0; row < model.rowCount(); ++row) {
+        const bool moves = row % 3 == 0;
+        samples[0].append(1000000);
+        samples[1].append(moves ? 1500000 : 1000000);
+    }
+    int tick = 0;
+
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.setCurrentFrequencies(samples[tick++ % 2]));
+    }
+    state.SetItemsProcessed(state.iterations() * model.rowCount());
+}
+
+// ============================================================================
+// FrequencySampler
+// ============================================================================
+
+static void BM_SamplerLatest(benchmark::State &state)
+{
+    Machine machine(cpuCount(state));
+    QList<int> cpus;
+    for (int cpu = 0; cpu < cpuCount(state); ++cpu) {
+        cpus.append(cpu);
+    }
+
+    // Sampling keeps running, so copies race with publishes like in the GUI
+    FrequencySampler sampler(machine.backend.get());
+    sampler.setCpus(cpus);
+    sampler.setInterval(1);
+    sampler.start();
+
+    QList<int> khz;
+    QList<int> busy;
+    QList<int> iowait;
+    while (!sampler.latest(khz, busy, iowait)) {
+        QThread::msleep(1);
+    }
+
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sampler.latest(khz, busy, iowait));
+    }
+    state.SetItemsProcessed(state.iterations() * cpus.size());
+
+    sampler.stop();
+}
+
+// ============================================================================
+// ProcStatSampler
+// ============================================================================
+
+static void BM_ProcStatParse(benchmark::State &state)
+{
+    // Two /proc/stat snapshots a tick apart, every CPU online
+    QList<int> cpus;
+    QByteArray before = "cpu  1000 0 1000 8000 100 0 0 0 0 0\n";
+    QByteArray after = "cpu  2000 0 1500 9000 150 0 0 0 0 0\n";
+    for (int cpu = 0; cpu < cpuCount(state); ++cpu) {
+        cpus.append(cpu);
+        before += "cpu" + QByteArray::number(cpu) + " 123456 78 23456 9876543 1234 0 567 0 0 0\n";
+        after += "cpu" + QByteArray::number(cpu) + " 123506 78 23476 9876563 1244 0 568 0 0 0\n";
+    }
+    before += "intr 123456 0 0 0\n";
+    after += "intr 123556 0 0 0\n";
+
+    ProcStatSampler sampler;
+    sampler.setCpus(cpus);
+    int tick = 0;
+
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        const QByteArray &content = (tick++ % 2) ? after : before;
+        sampler.parse(content.constData(), content.size());
+        benchmark::DoNotOptimize(sampler.busyPermille(0));
+    }
+    state.SetItemsProcessed(state.iterations() * cpus.size());
+}
+
+// ============================================================================
+// Helper metrics export
+// ============================================================================
+
+static void BM_MetricsExport(benchmark::State &state)
+{
+    // What MetricsExporter::exportNow() does before saving the file
+    Machine machine(cpuCount(state));
+    const MetricsRenderer::Counters counters;
+    QByteArray buffer;
+
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        const QList<CpuSnapshot> &snapshots = machine.reader->snapshotAll();
+        MetricsRenderer::render(buffer, snapshots, *machine.reader, counters);
+        benchmark::DoNotOptimize(buffer.constData());
+    }
+    state.SetItemsProcessed(state.iterations() * cpuCount(state));
+    state.counters["bytes"] = double(buffer.size());
+}
+
+#define CPU_COUNTS ->Arg(8)->Arg(64)->Arg(512)->Arg(4096)
+
+BENCHMARK(BM_CurrentFreq) CPU_COUNTS;
+BENCHMARK(BM_AvailableCpus) CPU_COUNTS;
+BENCHMARK(BM_ParseCpuList) CPU_COUNTS;
+BENCHMARK(BM_ParseList) CPU_COUNTS;
+BENCHMARK(BM_UpdateFromSystem) CPU_COUNTS;
+BENCHMARK(BM_RefreshAll) CPU_COUNTS;
+BENCHMARK(BM_SetCurrentFrequencies) CPU_COUNTS;
+BENCHMARK(BM_SamplerLatest) CPU_COUNTS;
+BENCHMARK(BM_ProcStatParse) CPU_COUNTS;
+// 256 CPUs is the size the 1 ms export budget is set for
+BENCHMARK(BM_MetricsExport) CPU_COUNTS->Arg(256);
+
+int main(int argc, char *argv[])
+{
+    // DbusHelper needs an application object; without a system bus it stays read-only
+    QCoreApplication app(argc, argv);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
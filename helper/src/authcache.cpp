@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "authcache.h"
+
+#include <QDBusServiceWatcher>
+#include <QDebug>
+
+#include <limits>
+
+AuthCache::AuthCache(const QDBusConnection &connection, int ttlSecs, int maxEntries, QObject *parent)
+    : QObject(parent)
+    , m_watcher(new QDBusServiceWatcher(this))
+    , m_ttlMs(qint64(ttlSecs) * 1000)
+    , m_maxEntries(qMax(1, maxEntries))
+{
+    m_clock.start();
+
+    // Only names with cached entries are watched, so the helper is not woken
+    // for unrelated bus traffic
+    m_watcher->setConnection(connection);
+    m_watcher->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
+    connect(m_watcher, &QDBusServiceWatcher::serviceUnregistered, this, &AuthCache::removeSender);
+}
+
+bool AuthCache::contains(const QString &sender, const QString &actionId)
+{
+    auto senderIt = m_entries.find(sender);
+    if (senderIt != m_entries.end()) {
+        auto actionIt = senderIt->find(actionId);
+        if (actionIt != senderIt->end()) {
+            if (actionIt.value() > now()) {
+                ++m_hits;
+                return true;
+            }
+
+            senderIt->erase(actionIt);
+            --m_size;
+            if (senderIt->isEmpty()) {
+                removeSender(sender);
+            }
+        }
+    }
+
+    ++m_misses;
+    return false;
+}
+
+void AuthCache::insert(const QString &sender, const QString &actionId)
+{
+    auto senderIt = m_entries.find(sender);
+    const bool known = senderIt != m_entries.end() && senderIt->contains(actionId);
+
+    if (!known) {
+        while (m_size >= m_maxEntries && !m_entries.isEmpty()) {
+            evictOne();
+        }
+        ++m_size;
+        if (!m_entries.contains(sender)) {
+            m_watcher->addWatchedService(sender);
+        }
+    }
+
+    m_entries[sender].insert(actionId, now() + m_ttlMs);
+}
+
+void AuthCache::removeSender(const QString &sender)
+{
+    auto it = m_entries.find(sender);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    qDebug() << "Dropping cached authorizations for" << sender;
+    m_size -= int(it->size());
+    m_entries.erase(it);
+    m_watcher->removeWatchedService(sender);
+}
+
+void AuthCache::clear()
+{
+    m_entries.clear();
+    m_size = 0;
+    m_watcher->setWatchedServices({});
+}
+
+void AuthCache::evictOne()
+{
+    QString victimSender;
+    QString victimAction;
+    qint64 victimExpiry = std::numeric_limits<qint64>::max();
+    const qint64 current = now();
+
+    for (auto senderIt = m_entries.cbegin(); senderIt != m_entries.cend(); ++senderIt) {
+        for (auto actionIt = senderIt->cbegin(); actionIt != senderIt->cend(); ++actionIt) {
+            if (actionIt.value() < victimExpiry) {
+                victimSender = senderIt.key();
+                victimAction = actionIt.key();
+                victimExpiry = actionIt.value();
+            }
+            // Anything already expired is as good a victim as any
+            if (victimExpiry <= current) {
+                break;
+            }
+        }
+        if (victimExpiry <= current) {
+            break;
+        }
+    }
+
+    auto senderIt = m_entries.find(victimSender);
+    if (senderIt == m_entries.end()) {
+        return;
+    }
+
+    senderIt->remove(victimAction);
+    --m_size;
+    ++m_evictions;
+    if (senderIt->isEmpty()) {
+        m_entries.erase(senderIt);
+        m_watcher->removeWatchedService(victimSender);
+    }
+}
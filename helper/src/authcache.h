@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef AUTHCACHE_H
+#define AUTHCACHE_H
+
+#include <QObject>
+#include <QDBusConnection>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+
+class QDBusServiceWatcher;
+
+/**
+ * @brief Bounded cache of polkit authorizations per bus name and action
+ *
+ * Entries expire after a fixed time to live and are dropped as soon as the
+ * client's unique bus name disappears (NameOwnerChanged with an empty new
+ * owner), so a long running helper does not accumulate dead senders. When
+ * full, expired entries go first, then the entry closest to expiry.
+ */
+class AuthCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AuthCache(const QDBusConnection &connection, int ttlSecs = DEFAULT_TTL_SECS,
+                       int maxEntries = DEFAULT_MAX_ENTRIES, QObject *parent = nullptr);
+    ~AuthCache() override = default;
+
+    // Counts a hit or a miss; expired entries are removed on lookup
+    bool contains(const QString &sender, const QString &actionId);
+    void insert(const QString &sender, const QString &actionId);
+    void removeSender(const QString &sender);
+    void clear();
+
+    int size() const { return m_size; }
+    quint64 hits() const { return m_hits; }
+    quint64 misses() const { return m_misses; }
+    quint64 evictions() const { return m_evictions; }
+
+    static constexpr int DEFAULT_TTL_SECS = 300;  // Same as polkit's auth_admin_keep
+    static constexpr int DEFAULT_MAX_ENTRIES = 256;
+
+private:
+    void evictOne();
+    qint64 now() const { return m_clock.elapsed(); }
+
+    QDBusServiceWatcher *m_watcher;
+    QElapsedTimer m_clock;
+
+    // sender -> action -> expiry (ms on m_clock)
+    QHash<QString, QHash<QString, qint64>> m_entries;
+    int m_size = 0;
+    qint64 m_ttlMs;
+    int m_maxEntries;
+
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+    quint64 m_evictions = 0;
+};
+
+#endif // AUTHCACHE_H
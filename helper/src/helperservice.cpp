@@ -2,21 +2,40 @@
 // SPDX-FileCopyrightText: 2024 cpupower-gui contributors
 
 #include "helperservice.h"
+#include "config/appconfig.h"
+#include "config/profilemanager.h"
+#include "core/sysfsbackend.h"
+#include "core/sysfsreader.h"
 
 #include <QCoreApplication>
 #include <QDBusConnection>
+#include <QDBusError>
 #include <QDBusInterface>
 #include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusMetaType>
 #include <QDBusReply>
-#include <QFile>
-#include <QTextStream>
-#include <QDir>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QRegularExpression>
+#include <QThread>
 
-HelperService::HelperService(QObject *parent)
+HelperService::HelperService(SysfsBackend *backend, QObject *parent)
     : QObject(parent)
+    , m_backend(backend)
+    , m_authCache(QDBusConnection::systemBus())
 {
+    qDBusRegisterMetaType<PlanEntry>();
+    qDBusRegisterMetaType<QList<PlanEntry>>();
+    qDBusRegisterMetaType<CpuState>();
+    qDBusRegisterMetaType<QList<CpuState>>();
+    qDBusRegisterMetaType<EffectiveFreq>();
+    qDBusRegisterMetaType<QList<EffectiveFreq>>();
+
+    // Workers for per-policy writes in apply_plan
+    m_writePool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), MAX_WRITE_WORKERS));
+    m_msrClock.start();
+
     // Setup idle timer
     m_idleTimer.setSingleShot(true);
     connect(&m_idleTimer, &QTimer::timeout, this, &HelperService::onIdleTimeout);
@@ -41,6 +60,12 @@ void HelperService::resetIdleTimer()
 
 void HelperService::onIdleTimeout()
 {
+    // Don't leave clients waiting on a polkit prompt without an answer
+    if (!m_pendingAuthorizations.isEmpty()) {
+        resetIdleTimer();
+        return;
+    }
+
     qInfo() << "Idle timeout reached, shutting down helper service";
     QCoreApplication::quit();
 }
@@ -61,13 +86,19 @@ bool HelperService::registerService()
     
     if (!systemBus.registerObject(QStringLiteral("/io/github/cpupower_gui/qt/helper"), 
                                    this,
-                                   QDBusConnection::ExportAllSlots)) {
+                                   QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals)) {
         qCritical() << "Cannot register D-Bus object:" << systemBus.lastError().message();
         return false;
     }
     
     qInfo() << "D-Bus helper service registered successfully";
     
+    // Report hotplug to clients while the helper is running
+    m_hotplugMonitor = new HotplugMonitor(this);
+    connect(m_hotplugMonitor, &HotplugMonitor::cpuHotplugged, this, &HelperService::onCpuHotplugged);
+    connect(m_hotplugMonitor, &HotplugMonitor::eventsLost, this, &HelperService::onHotplugEventsLost);
+    m_hotplugMonitor->start();
+
     // Start idle timer after successful registration
     resetIdleTimer();
     
@@ -81,29 +112,37 @@ bool HelperService::registerService()
 int HelperService::isauthorized()
 {
     resetIdleTimer();
-    return isAuthorized() ? 1 : 0;
+    return runAuthorized([]() -> QVariantList { return {1}; }, {0}).value(0).toInt();
 }
 
-bool HelperService::isAuthorized(const QString &actionId)
+QVariantList HelperService::runAuthorized(const AuthorizedWork &work, const QVariantList &denied,
+                                          const QString &actionId)
 {
     if (!calledFromDBus()) {
-        return true; // Local calls are always authorized
+        return work(); // Local calls are always authorized
     }
-    
-    QString sender = message().service();
-    return checkPolkitAuthorization(sender, actionId);
+
+    const QString sender = message().service();
+    if (m_authCache.contains(sender, actionId)) {
+        return work();
+    }
+
+    // Answer once polkit has decided. The event loop keeps serving other
+    // clients meanwhile, and further calls from the same sender join the
+    // request already in flight instead of raising a second prompt.
+    setDelayedReply(true);
+
+    PendingAuthorization &pending = m_pendingAuthorizations[sender + actionId];
+    pending.callers.append({message(), work, denied});
+    if (pending.callers.size() == 1) {
+        startPolkitCheck(sender, actionId);
+    }
+
+    return {};
 }
 
-bool HelperService::checkPolkitAuthorization(const QString &sender, const QString &actionId)
+void HelperService::startPolkitCheck(const QString &sender, const QString &actionId)
 {
-    // Check cache first
-    QString cacheKey = sender + actionId;
-    if (m_authorizedSenders.contains(cacheKey)) {
-        return m_authorizedSenders[cacheKey];
-    }
-    
-    QDBusConnection systemBus = QDBusConnection::systemBus();
-    
     // Build the CheckAuthorization call manually using QDBusMessage
     QDBusMessage msg = QDBusMessage::createMethodCall(
         QStringLiteral("org.freedesktop.PolicyKit1"),
@@ -140,52 +179,80 @@ bool HelperService::checkPolkitAuthorization(const QString &sender, const QStrin
         QString()  // empty cancellation_id
     });
     
-    // Make the call (blocking, with timeout for user interaction)
-    QDBusMessage reply = systemBus.call(msg, QDBus::Block, 120000);  // 2 minute timeout
+    // The user may take a while to answer the prompt
+    QDBusPendingCall call = QDBusConnection::systemBus().asyncCall(msg, POLKIT_TIMEOUT_MS);
+    auto *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this, sender, actionId](QDBusPendingCallWatcher *finished) {
+                finished->deleteLater();
+                onPolkitFinished(sender, actionId, finished->reply());
+            });
+}
+
+void HelperService::onPolkitFinished(const QString &sender, const QString &actionId, const QDBusMessage &reply)
+{
+    resetIdleTimer();
+
+    bool isAuthorized = false;
+    bool isChallenge = false;
     
     if (reply.type() == QDBusMessage::ErrorMessage) {
         qWarning() << "PolicyKit authorization failed:" << reply.errorMessage();
-        return false;
-    }
-    
-    if (reply.arguments().isEmpty()) {
+    } else if (reply.arguments().isEmpty()) {
         qWarning() << "PolicyKit returned empty response";
-        return false;
+    } else {
+        // Parse result: (bba{ss})
+        // We need to extract just the first two booleans (is_authorized, is_challenge)
+        const QDBusArgument resultArg = reply.arguments().at(0).value<QDBusArgument>();
+        
+        resultArg.beginStructure();
+        resultArg >> isAuthorized;
+        resultArg >> isChallenge;
+        // Must read the a{ss} map to fully consume the struct
+        resultArg.beginMap();
+        while (!resultArg.atEnd()) {
+            resultArg.beginMapEntry();
+            QString key, value;
+            resultArg >> key >> value;
+            resultArg.endMapEntry();
+        }
+        resultArg.endMap();
+        resultArg.endStructure();
+        
+        qDebug() << "PolicyKit authorization result: authorized=" << isAuthorized << "challenge=" << isChallenge;
     }
     
-    // Parse result: (bba{ss})
-    // We need to extract just the first boolean (is_authorized)
-    QVariant resultVariant = reply.arguments().at(0);
-    
-    // The result is a struct, extract it via QDBusArgument
-    const QDBusArgument resultArg = resultVariant.value<QDBusArgument>();
-    
-    bool isAuthorized = false;
-    bool isChallenge = false;
-    
-    // Read the struct
-    resultArg.beginStructure();
-    resultArg >> isAuthorized;
-    resultArg >> isChallenge;
-    // Must read the a{ss} map to fully consume the struct
-    resultArg.beginMap();
-    while (!resultArg.atEnd()) {
-        resultArg.beginMapEntry();
-        QString key, value;
-        resultArg >> key >> value;
-        resultArg.endMapEntry();
-    }
-    resultArg.endMap();
-    resultArg.endStructure();
-    
-    qDebug() << "PolicyKit authorization result: authorized=" << isAuthorized << "challenge=" << isChallenge;
-    
     // Cache result (only if authorized without challenge)
     if (isAuthorized && !isChallenge) {
-        m_authorizedSenders[cacheKey] = true;
+        m_authCache.insert(sender, actionId);
     }
-    
-    return isAuthorized;
+
+    // Answer every call that waited on this check, in arrival order
+    const QList<PendingCaller> callers = m_pendingAuthorizations.take(sender + actionId).callers;
+    if (!isAuthorized) {
+        m_authDenied += quint64(callers.size());
+    }
+    for (const PendingCaller &caller : callers) {
+        const QVariantList arguments = isAuthorized ? caller.work() : caller.denied;
+        QDBusConnection::systemBus().send(caller.message.createReply(arguments));
+    }
+}
+
+QVariantMap HelperService::get_statistics()
+{
+    resetIdleTimer();
+
+    return {
+        {QStringLiteral("auth_cache_entries"), m_authCache.size()},
+        {QStringLiteral("auth_cache_hits"), m_authCache.hits()},
+        {QStringLiteral("auth_cache_misses"), m_authCache.misses()},
+        {QStringLiteral("auth_cache_evictions"), m_authCache.evictions()},
+        {QStringLiteral("auth_pending"), int(m_pendingAuthorizations.size())},
+        {QStringLiteral("changes_applied"), m_changesApplied},
+        {QStringLiteral("change_failures"), m_changeFailures},
+        {QStringLiteral("auth_denied"), m_authDenied},
+        {QStringLiteral("sysfs_writes"), sysfsWrites()},
+    };
 }
 
 // ============================================================================
@@ -202,27 +269,28 @@ QList<int> HelperService::get_cpus_available()
 QList<int> HelperService::get_cpus_online()
 {
     resetIdleTimer();
-    QString content = readSysfsFile(QStringLiteral("%1/online").arg(SYS_CPU_PATH));
-    return parseCpuList(content);
+    refreshCpuMasks();
+    return m_onlineMask.toList();
 }
 
 QList<int> HelperService::get_cpus_offline()
 {
     resetIdleTimer();
-    QString content = readSysfsFile(QStringLiteral("%1/offline").arg(SYS_CPU_PATH));
+    QString content = readSysfsFile(QStringLiteral("offline"));
     return parseCpuList(content);
 }
 
 QList<int> HelperService::get_cpus_present()
 {
     resetIdleTimer();
-    QString content = readSysfsFile(QStringLiteral("%1/present").arg(SYS_CPU_PATH));
-    return parseCpuList(content);
+    refreshCpuMasks();
+    return m_presentMask.toList();
 }
 
 QStringList HelperService::get_cpu_governors(int cpu)
 {
     resetIdleTimer();
+    refreshCpuMasks();
     if (!isPresent(cpu) || !isOnline(cpu)) {
         return QStringList();
     }
@@ -234,6 +302,7 @@ QStringList HelperService::get_cpu_governors(int cpu)
 QStringList HelperService::get_cpu_energy_preferences(int cpu)
 {
     resetIdleTimer();
+    refreshCpuMasks();
     if (!isPresent(cpu) || !isOnline(cpu)) {
         return QStringList();
     }
@@ -245,6 +314,7 @@ QStringList HelperService::get_cpu_energy_preferences(int cpu)
 QString HelperService::get_cpu_governor(int cpu)
 {
     resetIdleTimer();
+    refreshCpuMasks();
     if (!isPresent(cpu) || !isOnline(cpu)) {
         return QString();
     }
@@ -255,6 +325,7 @@ QString HelperService::get_cpu_governor(int cpu)
 QString HelperService::get_cpu_energy_preference(int cpu)
 {
     resetIdleTimer();
+    refreshCpuMasks();
     if (!isPresent(cpu) || !isOnline(cpu)) {
         return QString();
     }
@@ -265,6 +336,7 @@ QString HelperService::get_cpu_energy_preference(int cpu)
 QList<int> HelperService::get_cpu_frequencies(int cpu)
 {
     resetIdleTimer();
+    refreshCpuMasks();
     QList<int> result;
     
     if (!isPresent(cpu) || !isOnline(cpu)) {
@@ -281,6 +353,7 @@ QList<int> HelperService::get_cpu_frequencies(int cpu)
 QList<int> HelperService::get_cpu_limits(int cpu)
 {
     resetIdleTimer();
+    refreshCpuMasks();
     QList<int> result;
     
     if (!isPresent(cpu) || !isOnline(cpu)) {
@@ -294,11 +367,175 @@ QList<int> HelperService::get_cpu_limits(int cpu)
     return result;
 }
 
+QList<CpuState> HelperService::get_state_all()
+{
+    resetIdleTimer();
+    refreshCpuMasks();
+
+    const QList<int> cpus = m_presentMask.toList();
+    QList<CpuState> result;
+    result.reserve(cpus.size());
+
+    for (int cpu : cpus) {
+        CpuState state;
+        state.cpu = cpu;
+        state.online = isOnline(cpu);
+
+        if (state.online) {
+            const QString base = cpufreqPath(cpu);
+            state.freqMin = readSysfsFile(QStringLiteral("%1/%2").arg(base, SCALING_MIN_FREQ)).trimmed().toInt();
+            state.freqMax = readSysfsFile(QStringLiteral("%1/%2").arg(base, SCALING_MAX_FREQ)).trimmed().toInt();
+            state.hwMin = readSysfsFile(QStringLiteral("%1/%2").arg(base, CPUINFO_MIN_FREQ)).trimmed().toInt();
+            state.hwMax = readSysfsFile(QStringLiteral("%1/%2").arg(base, CPUINFO_MAX_FREQ)).trimmed().toInt();
+            state.governor = readSysfsFile(QStringLiteral("%1/%2").arg(base, SCALING_GOVERNOR)).trimmed();
+            state.energyPref = readSysfsFile(QStringLiteral("%1/%2").arg(base, ENERGY_PERF_PREF)).trimmed();
+        }
+
+        result.append(state);
+    }
+
+    return result;
+}
+
+QList<EffectiveFreq> HelperService::get_effective_freqs(const QList<int> &cpus, uint windowMs)
+{
+    resetIdleTimer();
+
+    // Every MSR read interrupts its CPU: bound how often clients can ask
+    const qint64 nowNs = m_msrClock.nsecsElapsed();
+    if (calledFromDBus()) {
+        if (m_effectiveBusy
+            || (m_lastEffectiveStartNs >= 0 && nowNs - m_lastEffectiveStartNs < EFFECTIVE_MIN_PERIOD_MS * 1000000)) {
+            sendErrorReply(QDBusError::LimitsExceeded,
+                           QStringLiteral("Effective frequencies are measured at most every %1 ms")
+                               .arg(EFFECTIVE_MIN_PERIOD_MS));
+            return {};
+        }
+        m_lastEffectiveStartNs = nowNs;
+    }
+
+    // Each online CPU at most once, whatever the client sent
+    refreshCpuMasks();
+    CpuMask targetMask;
+    if (cpus.isEmpty()) {
+        targetMask = m_onlineMask;
+    } else {
+        for (int cpu : cpus) {
+            if (m_onlineMask.test(cpu)) {
+                targetMask.set(cpu);
+            }
+        }
+    }
+    const QList<int> targets = targetMask.toList();
+
+    const uint window = qBound(MIN_EFFECTIVE_WINDOW_MS, windowMs, MAX_EFFECTIVE_WINDOW_MS);
+    const QList<MsrSample> before = sampleMsrs(targets);
+
+    if (!calledFromDBus()) {
+        QThread::msleep(window);
+        return finishEffectiveFreqs(before, targets);
+    }
+
+    // Don't block the bus for the window, answer from a timer instead
+    m_effectiveBusy = true;
+    setDelayedReply(true);
+    const QDBusMessage request = message();
+    QTimer::singleShot(int(window), this, [this, request, targets, before]() {
+        const QList<EffectiveFreq> result = finishEffectiveFreqs(before, targets);
+        m_effectiveBusy = false;
+        QDBusConnection::systemBus().send(request.createReply(QVariant::fromValue(result)));
+        resetIdleTimer();
+    });
+    return {};
+}
+
+QList<EffectiveFreq> HelperService::finishEffectiveFreqs(const QList<MsrSample> &before, const QList<int> &cpus)
+{
+    const QList<MsrSample> after = sampleMsrs(cpus);
+    calibrateTsc(before, after);
+    return effectiveFreqs(before, after, m_tscKhz);
+}
+
+void HelperService::calibrateTsc(const QList<MsrSample> &before, const QList<MsrSample> &after)
+{
+    // One CPU is enough: the TSC ticks at the same rate everywhere, and its
+    // reads are timestamped individually, so the sweep doesn't skew the span
+    for (qsizetype i = 0; i < before.size() && i < after.size(); ++i) {
+        const MsrSample &a = before.at(i);
+        const MsrSample &b = after.at(i);
+        if (!a.valid || !b.valid || b.tsc <= a.tsc) {
+            continue;
+        }
+        const qint64 spanNs = b.tscNs - a.tscNs;
+        if (spanNs > m_tscCalibrationNs) {
+            m_tscKhz = double(b.tsc - a.tsc) * 1e6 / double(spanNs);
+            m_tscCalibrationNs = spanNs;
+        }
+        return;
+    }
+}
+
+QList<HelperService::MsrSample> HelperService::sampleMsrs(const QList<int> &cpus)
+{
+    QList<MsrSample> samples;
+    samples.reserve(cpus.size());
+
+    for (int cpu : cpus) {
+        MsrSample sample;
+        sample.cpu = cpu;
+        sample.valid = m_msr.read(cpu, MsrReader::IA32_APERF, sample.aperf)
+                && m_msr.read(cpu, MsrReader::IA32_MPERF, sample.mperf)
+                && m_msr.read(cpu, MsrReader::IA32_TIME_STAMP_COUNTER, sample.tsc);
+        sample.tscNs = m_msrClock.nsecsElapsed();
+        samples.append(sample);
+    }
+
+    return samples;
+}
+
+QList<EffectiveFreq> HelperService::effectiveFreqs(const QList<MsrSample> &before,
+                                                   const QList<MsrSample> &after, double tscKhz)
+{
+    QList<EffectiveFreq> result;
+    if (tscKhz <= 0) {
+        return result;
+    }
+    result.reserve(before.size());
+
+    for (qsizetype i = 0; i < before.size() && i < after.size(); ++i) {
+        const MsrSample &a = before.at(i);
+        const MsrSample &b = after.at(i);
+        if (!a.valid || !b.valid) {
+            continue;
+        }
+
+        // The counters are 64 bit and don't wrap in practice; a reset
+        // (e.g. the CPU went through suspend) shows up as a step back
+        const quint64 aperf = b.aperf - a.aperf;
+        const quint64 mperf = b.mperf - a.mperf;
+        const quint64 tsc = b.tsc - a.tsc;
+        if (b.aperf < a.aperf || b.mperf < a.mperf || b.tsc <= a.tsc) {
+            continue;
+        }
+
+        // Ratios of this CPU's own deltas, so the time between its reads
+        // and those of other CPUs doesn't matter
+        EffectiveFreq freq;
+        freq.cpu = a.cpu;
+        freq.avgKhz = int(tscKhz * double(aperf) / double(tsc));
+        freq.busyKhz = mperf > 0 ? int(tscKhz * double(aperf) / double(mperf)) : 0;
+        freq.c0Residency = qBound(0.0, double(mperf) / double(tsc), 1.0);
+        result.append(freq);
+    }
+
+    return result;
+}
+
 int HelperService::cpu_allowed_offline(int cpu)
 {
     resetIdleTimer();
-    QString path = QStringLiteral("%1/cpu%2/%3").arg(SYS_CPU_PATH).arg(cpu).arg(ONLINE_FILE);
-    return QFile::exists(path) ? 1 : 0;
+    QString path = QStringLiteral("%1/%2").arg(cpuPath(cpu), ONLINE_FILE);
+    return m_backend->exists(path) ? 1 : 0;
 }
 
 // ============================================================================
@@ -310,177 +547,471 @@ int HelperService::update_cpu_settings(int cpu, int freq_min, int freq_max)
     resetIdleTimer();
     qDebug() << "update_cpu_settings called: cpu=" << cpu << "freq_min=" << freq_min << "freq_max=" << freq_max;
     
-    if (!isAuthorized()) {
-        qWarning() << "Not authorized";
-        return -1;
-    }
-    
-    if (!isPresent(cpu) || !isOnline(cpu)) {
-        qWarning() << "CPU" << cpu << "not present or not online";
-        return -1;
-    }
-    
-    QString basePath = cpufreqPath(cpu);
-    
-    // Read current values to determine write order
-    QString curMinStr = readSysfsFile(QStringLiteral("%1/%2").arg(basePath, SCALING_MIN_FREQ)).trimmed();
-    QString curMaxStr = readSysfsFile(QStringLiteral("%1/%2").arg(basePath, SCALING_MAX_FREQ)).trimmed();
-    int curMin = curMinStr.toInt();
-    int curMax = curMaxStr.toInt();
-    
-    qDebug() << "Current values: min=" << curMin << "max=" << curMax;
-    qDebug() << "Target values: min=" << freq_min << "max=" << freq_max;
-    
-    // Determine the correct order to avoid temporary invalid states
-    // Rule: min <= max must always be true
-    // If new_max < cur_min, we must lower min first
-    // If new_min > cur_max, we must raise max first
-    
-    bool success = true;
-    
-    if (freq_max < curMin) {
-        // New max is lower than current min - must lower min first
-        qDebug() << "Lowering min first (new max < current min)";
-        if (!writeSysfsFile(QStringLiteral("%1/%2").arg(basePath, SCALING_MIN_FREQ), 
-                            QString::number(freq_min))) {
-            qWarning() << "Failed to write min frequency";
-            success = false;
+    return runAuthorized([this, cpu, freq_min, freq_max]() -> QVariantList {
+        refreshCpuMasks();
+        if (!isPresent(cpu) || !isOnline(cpu)) {
+            qWarning() << "CPU" << cpu << "not present or not online";
+            return {countResult(-1)};
         }
-        if (!writeSysfsFile(QStringLiteral("%1/%2").arg(basePath, SCALING_MAX_FREQ), 
-                            QString::number(freq_max))) {
-            qWarning() << "Failed to write max frequency";
-            success = false;
+
+        int writes = 0;
+        const int status = writeFrequencyLimits(cpu, freq_min, freq_max, writes);
+        notifyPolicyChanged(cpu, status, CpuField::Frequencies);
+        return {countResult(status)};
+    }).value(0).toInt();
+}
+
+int HelperService::update_cpu_governor(int cpu, const QString &governor)
+{
+    resetIdleTimer();
+    return runAuthorized([this, cpu, governor]() -> QVariantList {
+        refreshCpuMasks();
+        if (!isPresent(cpu) || !isOnline(cpu)) {
+            return {countResult(-1)};
         }
-    } else if (freq_min > curMax) {
-        // New min is higher than current max - must raise max first
-        qDebug() << "Raising max first (new min > current max)";
-        if (!writeSysfsFile(QStringLiteral("%1/%2").arg(basePath, SCALING_MAX_FREQ), 
-                            QString::number(freq_max))) {
-            qWarning() << "Failed to write max frequency";
-            success = false;
+
+        int writes = 0;
+        const int status = writeIfChanged(QStringLiteral("%1/%2").arg(cpufreqPath(cpu), SCALING_GOVERNOR), governor, writes);
+        notifyPolicyChanged(cpu, status, CpuField::Governor);
+        return {countResult(status)};
+    }).value(0).toInt();
+}
+
+int HelperService::update_cpu_energy_prefs(int cpu, const QString &pref)
+{
+    resetIdleTimer();
+    return runAuthorized([this, cpu, pref]() -> QVariantList {
+        refreshCpuMasks();
+        if (!isPresent(cpu) || !isOnline(cpu)) {
+            return {countResult(-1)};
         }
-        if (!writeSysfsFile(QStringLiteral("%1/%2").arg(basePath, SCALING_MIN_FREQ), 
-                            QString::number(freq_min))) {
-            qWarning() << "Failed to write min frequency";
-            success = false;
+
+        int writes = 0;
+        const int status = writeEnergyPref(cpu, pref, writes);
+        notifyPolicyChanged(cpu, status, CpuField::EnergyPref);
+        return {countResult(status)};
+    }).value(0).toInt();
+}
+
+int HelperService::set_cpu_online(int cpu)
+{
+    resetIdleTimer();
+    return runAuthorized([this, cpu]() -> QVariantList {
+        QString path = QStringLiteral("%1/%2").arg(cpuPath(cpu), ONLINE_FILE);
+
+        if (!m_backend->exists(path)) {
+            return {countResult(-1)}; // CPU 0 usually can't be offlined
         }
-    } else {
-        // No conflict - write in standard order (min first, then max)
-        qDebug() << "Standard order (no conflict)";
-        if (!writeSysfsFile(QStringLiteral("%1/%2").arg(basePath, SCALING_MIN_FREQ), 
-                            QString::number(freq_min))) {
-            qWarning() << "Failed to write min frequency";
-            success = false;
+
+        int writes = 0;
+        const int status = writeIfChanged(path, QStringLiteral("1"), writes);
+        if (status == HelperStatus::Ok) {
+            notifyStateChanged({cpu}, CpuField::Online);
         }
-        if (!writeSysfsFile(QStringLiteral("%1/%2").arg(basePath, SCALING_MAX_FREQ), 
-                            QString::number(freq_max))) {
-            qWarning() << "Failed to write max frequency";
-            success = false;
+        return {countResult(status)};
+    }).value(0).toInt();
+}
+
+int HelperService::set_cpu_offline(int cpu)
+{
+    resetIdleTimer();
+    return runAuthorized([this, cpu]() -> QVariantList {
+        QString path = QStringLiteral("%1/%2").arg(cpuPath(cpu), ONLINE_FILE);
+
+        if (!m_backend->exists(path)) {
+            return {countResult(-1)};
         }
-    }
-    
-    // Verify the result
-    QString newMinStr = readSysfsFile(QStringLiteral("%1/%2").arg(basePath, SCALING_MIN_FREQ)).trimmed();
-    QString newMaxStr = readSysfsFile(QStringLiteral("%1/%2").arg(basePath, SCALING_MAX_FREQ)).trimmed();
-    qDebug() << "After write: min=" << newMinStr << "max=" << newMaxStr;
-    
-    return success ? 0 : -13;
+
+        int writes = 0;
+        const int status = writeIfChanged(path, QStringLiteral("0"), writes);
+        if (status == HelperStatus::Ok) {
+            notifyStateChanged({cpu}, CpuField::Online);
+        }
+        return {countResult(status)};
+    }).value(0).toInt();
 }
 
-int HelperService::update_cpu_governor(int cpu, const QString &governor)
+void HelperService::quit()
+{
+    qInfo() << "Quit requested, shutting down helper service...";
+    QCoreApplication::quit();
+}
+
+// ============================================================================
+// Batched plan
+// ============================================================================
+
+QList<int> HelperService::apply_plan(const QList<PlanEntry> &plan, int &writes)
 {
     resetIdleTimer();
-    if (!isAuthorized()) {
-        return -1;
+    qDebug() << "apply_plan called with" << plan.size() << "entries";
+
+    // One polkit check for the whole plan
+    const QList<int> denied(plan.size(), HelperStatus::NotAuthorized);
+    const QVariantList reply = runAuthorized([this, plan]() -> QVariantList {
+        int planWrites = 0;
+        const QList<int> statuses = applyPlan(plan, planWrites);
+        for (int status : statuses) {
+            countResult(status);
+        }
+        return {QVariant::fromValue(statuses), planWrites};
+    }, {QVariant::fromValue(denied), 0});
+
+    writes = reply.value(1).toInt();
+    return reply.value(0).value<QList<int>>();
+}
+
+int HelperService::apply_default_profile()
+{
+    resetIdleTimer();
+
+    return runAuthorized([this]() -> QVariantList { return {applyDefaultProfile()}; },
+                         {int(HelperStatus::NotAuthorized)},
+                         QStringLiteral("io.github.cpupower_gui.qt.apply_persist")).value(0).toInt();
+}
+
+int HelperService::applyDefaultProfile()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // The driver is usually loaded by udev from the CPU modalias, which may
+    // not have happened yet this early in boot
+    const QString cpufreqPath = QStringLiteral("%1/%2").arg(cpuPath(0), CPUFREQ_DIR);
+    while (!m_backend->exists(cpufreqPath) && timer.elapsed() < CPUFREQ_WAIT_TIMEOUT_MS) {
+        QThread::msleep(CPUFREQ_POLL_MS);
     }
-    
-    if (!isPresent(cpu) || !isOnline(cpu)) {
-        return -1;
+    const qint64 waitNs = timer.nsecsElapsed();
+    if (!m_backend->exists(cpufreqPath)) {
+        qWarning() << "No cpufreq policy after" << waitNs / 1000000 << "ms, applying what is available";
     }
-    
-    QString path = QStringLiteral("%1/%2").arg(cpufreqPath(cpu), SCALING_GOVERNOR);
-    
-    if (!writeSysfsFile(path, governor)) {
-        return -13;
+
+    // Boot and persist run as root; root's own ~/.config must not decide them
+    const AppConfig config(AppConfig::Scope::SystemOnly);
+    SysfsReader sysfs(m_backend);
+    const ProfileManager profiles(&sysfs, ProfileManager::Scope::SystemOnly);
+    const QString name = config.defaultProfile();
+    const Profile *profile = profiles.profile(name);
+    if (!profile) {
+        qWarning() << "Default profile" << name << "not found";
+        return countResult(HelperStatus::NoProfile);
     }
-    
-    return 0;
+
+    const QList<PlanEntry> plan = ProfileManager::compilePlan(*profile, &sysfs);
+    const qint64 loadNs = timer.nsecsElapsed();
+
+    int writes = 0;
+    const QList<int> statuses = applyPlan(plan, writes);
+    int result = HelperStatus::Unchanged;
+    for (int status : statuses) {
+        result = mergeStatus(result, countResult(status));
+    }
+    const qint64 totalNs = timer.nsecsElapsed();
+
+    qInfo().nospace() << "Applied default profile \"" << name << "\" to " << plan.size() << " CPUs with "
+                      << writes << " writes in " << totalNs / 1000 << " us (cpufreq wait " << waitNs / 1000
+                      << " us, load and compile " << (loadNs - waitNs) / 1000 << " us, apply "
+                      << (totalNs - loadNs) / 1000 << " us), status " << result;
+    return result;
 }
 
-int HelperService::update_cpu_energy_prefs(int cpu, const QString &pref)
+QList<int> HelperService::applyPlan(const QList<PlanEntry> &plan, int &writes)
 {
-    resetIdleTimer();
-    if (!isAuthorized()) {
-        return -1;
+    writes = 0;
+    refreshCpuMasks();
+
+    QList<int> statuses(plan.size(), HelperStatus::Unchanged);
+
+    // Hotplug updates the CPU masks, so it runs here before any cpufreq write.
+    // Entries that stay online are grouped by the cpufreq policy they belong to.
+    QMap<int, QList<qsizetype>> policies;
+    CpuMask changed;
+    for (qsizetype i = 0; i < plan.size(); ++i) {
+        const PlanEntry &entry = plan.at(i);
+        statuses[i] = applyOnlineState(entry, writes);
+        if (statuses.at(i) == HelperStatus::Ok) {
+            changed.set(entry.cpu);
+        }
+        if (statuses.at(i) >= 0 && entry.online) {
+            policies[policyOf(entry.cpu)].append(i);
+        }
     }
-    
-    if (!isPresent(cpu) || !isOnline(cpu)) {
-        return -1;
+
+    // Policies are independent: the kernel serializes governor restarts per
+    // policy, so writing them from several threads scales with the workers
+    int *statusData = statuses.data();
+    QList<int> policyWrites(policies.size(), 0);
+    int *writeData = policyWrites.data();
+
+    if (policies.size() == 1) {
+        applyPolicyEntries(plan, policies.first(), statusData, writeData[0]);
+    } else {
+        qsizetype task = 0;
+        for (auto it = policies.cbegin(); it != policies.cend(); ++it, ++task) {
+            const QList<qsizetype> entries = it.value();
+            int &taskWrites = writeData[task];
+            m_writePool.start([this, &plan, entries, statusData, &taskWrites]() {
+                applyPolicyEntries(plan, entries, statusData, taskWrites);
+            });
+        }
+        m_writePool.waitForDone();
     }
-    
-    // Check if pref is available
-    QStringList available = get_cpu_energy_preferences(cpu);
-    if (!available.contains(pref)) {
-        return 0; // Not an error, just not available
+
+    for (int count : std::as_const(policyWrites)) {
+        writes += count;
     }
-    
-    QString path = QStringLiteral("%1/%2").arg(cpufreqPath(cpu), ENERGY_PERF_PREF);
-    
-    if (!QFile::exists(path)) {
-        return 0;
+
+    // A cpufreq write changes every CPU of the policy, not just the plan entry
+    uint fields = changed.isEmpty() ? 0 : uint(CpuField::Online);
+    for (auto it = policies.cbegin(); it != policies.cend(); ++it) {
+        uint policyFields = 0;
+        for (qsizetype index : it.value()) {
+            if (statuses.at(index) == HelperStatus::Ok) {
+                policyFields |= plan.at(index).fields();
+            }
+        }
+        if (policyFields != 0) {
+            fields |= policyFields;
+            for (int cpu : policyCpus(it.key()).toList()) {
+                changed.set(cpu);
+            }
+        }
     }
-    
-    if (!writeSysfsFile(path, pref)) {
-        return -13;
+    notifyStateChanged(changed.toList(), fields);
+
+    qDebug() << "apply_plan touched" << policies.size() << "policies with" << writes << "writes";
+    return statuses;
+}
+
+int HelperService::applyOnlineState(const PlanEntry &entry, int &writes)
+{
+    const int cpu = entry.cpu;
+    if (!isPresent(cpu)) {
+        qWarning() << "CPU" << cpu << "not present";
+        return HelperStatus::NotPresent;
     }
-    
-    return 0;
+
+    const QString onlinePath = QStringLiteral("%1/%2").arg(cpuPath(cpu), ONLINE_FILE);
+
+    if (!entry.online) {
+        if (!isOnline(cpu)) {
+            return HelperStatus::Unchanged;
+        }
+        if (!m_backend->exists(onlinePath)) {
+            return HelperStatus::CannotOffline;
+        }
+        if (!writeSysfsFile(onlinePath, QStringLiteral("0"))) {
+            return HelperStatus::WriteFailed;
+        }
+        ++writes;
+        m_onlineMask.clear(cpu);
+        return HelperStatus::Ok;
+    }
+
+    // Bring the CPU online before touching its cpufreq policy
+    if (isOnline(cpu)) {
+        return HelperStatus::Unchanged;
+    }
+    if (!m_backend->exists(onlinePath) || !writeSysfsFile(onlinePath, QStringLiteral("1"))) {
+        return HelperStatus::WriteFailed;
+    }
+    ++writes;
+    m_onlineMask.set(cpu);
+    return HelperStatus::Ok;
 }
 
-int HelperService::set_cpu_online(int cpu)
+void HelperService::applyPolicyEntries(const QList<PlanEntry> &plan, const QList<qsizetype> &entries,
+                                       int *statuses, int &writes)
 {
-    resetIdleTimer();
-    if (!isAuthorized()) {
-        return -1;
+    // CPUs sharing a cpufreq policy share its attributes; repeating a write
+    // for every member would only restart the governor again
+    PlanEntry written;
+
+    for (qsizetype index : entries) {
+        const PlanEntry &entry = plan.at(index);
+        const int cpu = entry.cpu;
+        int status = statuses[index];
+
+        if (entry.hasFrequencies()
+            && (entry.freqMin != written.freqMin || entry.freqMax != written.freqMax)) {
+            const int result = writeFrequencyLimits(cpu, entry.freqMin, entry.freqMax, writes);
+            if (result >= 0) {
+                written.freqMin = entry.freqMin;
+                written.freqMax = entry.freqMax;
+            }
+            status = mergeStatus(status, result);
+        }
+
+        if (!entry.governor.isEmpty() && entry.governor != written.governor) {
+            const QString path = QStringLiteral("%1/%2").arg(cpufreqPath(cpu), SCALING_GOVERNOR);
+            const int result = writeIfChanged(path, entry.governor, writes);
+            if (result >= 0) {
+                written.governor = entry.governor;
+            }
+            status = mergeStatus(status, result);
+        }
+
+        if (!entry.energyPref.isEmpty() && entry.energyPref != written.energyPref) {
+            const int result = writeEnergyPref(cpu, entry.energyPref, writes);
+            if (result >= 0) {
+                written.energyPref = entry.energyPref;
+            }
+            status = mergeStatus(status, result);
+        }
+
+        statuses[index] = status;
     }
-    
-    QString path = QStringLiteral("%1/cpu%2/%3").arg(SYS_CPU_PATH).arg(cpu).arg(ONLINE_FILE);
-    
-    if (!QFile::exists(path)) {
-        return -1; // CPU 0 usually can't be offlined
+}
+
+int HelperService::policyOf(int cpu) const
+{
+    // The kernel names policyN after its first CPU
+    const int policy = policyCpus(cpu).first();
+    return policy >= 0 ? policy : cpu;
+}
+
+CpuMask HelperService::policyCpus(int cpu) const
+{
+    QString content = readSysfsFile(QStringLiteral("%1/%2").arg(cpufreqPath(cpu), RELATED_CPUS));
+    if (content.trimmed().isEmpty()) {
+        content = readSysfsFile(QStringLiteral("%1/%2").arg(cpufreqPath(cpu), AFFECTED_CPUS));
     }
-    
-    if (!writeSysfsFile(path, QStringLiteral("1"))) {
-        return -13;
+
+    CpuMask cpus = CpuMask::fromCpuList(content.toLatin1());
+    if (cpus.isEmpty()) {
+        cpus.set(cpu);
     }
-    
-    return 0;
+    return cpus;
 }
 
-int HelperService::set_cpu_offline(int cpu)
+// ============================================================================
+// Change notification
+// ============================================================================
+
+void HelperService::notifyStateChanged(const QList<int> &cpus, uint fields)
 {
-    resetIdleTimer();
-    if (!isAuthorized()) {
-        return -1;
+    if (cpus.isEmpty() || fields == 0) {
+        return;
     }
-    
-    QString path = QStringLiteral("%1/cpu%2/%3").arg(SYS_CPU_PATH).arg(cpu).arg(ONLINE_FILE);
-    
-    if (!QFile::exists(path)) {
-        return -1;
+
+    qDebug() << "CpuStateChanged:" << cpus.size() << "CPUs, fields" << Qt::hex << fields;
+    Q_EMIT CpuStateChanged(cpus, fields);
+}
+
+void HelperService::notifyPolicyChanged(int cpu, int status, uint fields)
+{
+    if (status == HelperStatus::Ok) {
+        notifyStateChanged(policyCpus(cpu).toList(), fields);
     }
-    
-    if (!writeSysfsFile(path, QStringLiteral("0"))) {
-        return -13;
+}
+
+void HelperService::onCpuHotplugged(int cpu, HotplugMonitor::Action action)
+{
+    Q_UNUSED(action)
+
+    // Clients should re-read the whole CPU, its cpufreq directory may be new
+    notifyStateChanged({cpu}, CpuField::All);
+}
+
+void HelperService::onHotplugEventsLost()
+{
+    // Some hotplug went unreported; have clients re-read every present CPU
+    refreshCpuMasks();
+    notifyStateChanged(m_presentMask.toList(), CpuField::All);
+}
+
+// ============================================================================
+// Read-compare-write
+// ============================================================================
+
+int HelperService::mergeStatus(int current, int next)
+{
+    // Failures win, then "applied", then "unchanged"
+    if (current < 0 || next < 0) {
+        return qMin(current, next);
     }
-    
-    return 0;
+    if (current == HelperStatus::Ok || next == HelperStatus::Ok) {
+        return HelperStatus::Ok;
+    }
+    return HelperStatus::Unchanged;
 }
 
-void HelperService::quit()
+int HelperService::writeIfChanged(const QString &path, const QString &value, int &writes)
 {
-    qInfo() << "Quit requested, shutting down helper service...";
-    QCoreApplication::quit();
+    // Rewriting the same governor still restarts it in the kernel
+    if (readSysfsFile(path).trimmed() == value) {
+        return HelperStatus::Unchanged;
+    }
+
+    if (!writeSysfsFile(path, value)) {
+        return HelperStatus::WriteFailed;
+    }
+
+    ++writes;
+    return HelperStatus::Ok;
+}
+
+int HelperService::writeEnergyPref(int cpu, const QString &pref, int &writes)
+{
+    const QString path = QStringLiteral("%1/%2").arg(cpufreqPath(cpu), ENERGY_PERF_PREF);
+    if (!m_backend->exists(path)) {
+        return HelperStatus::Unchanged;
+    }
+
+    // Unsupported preferences are not an error, there is just nothing to do
+    const QStringList available = parseList(readSysfsFile(QStringLiteral("%1/%2").arg(cpufreqPath(cpu), ENERGY_PERF_AVAIL)));
+    if (!available.contains(pref)) {
+        return HelperStatus::Unchanged;
+    }
+
+    return writeIfChanged(path, pref, writes);
+}
+
+int HelperService::writeFrequencyLimits(int cpu, int freqMin, int freqMax, int &writes)
+{
+    const QString minPath = QStringLiteral("%1/%2").arg(cpufreqPath(cpu), SCALING_MIN_FREQ);
+    const QString maxPath = QStringLiteral("%1/%2").arg(cpufreqPath(cpu), SCALING_MAX_FREQ);
+
+    // Read current values to skip no-op writes and to determine write order
+    const int curMin = readSysfsFile(minPath).trimmed().toInt();
+    const int curMax = readSysfsFile(maxPath).trimmed().toInt();
+
+    qDebug() << "Current values: min=" << curMin << "max=" << curMax;
+    qDebug() << "Target values: min=" << freqMin << "max=" << freqMax;
+
+    if (freqMin == curMin && freqMax == curMax) {
+        return HelperStatus::Unchanged;
+    }
+
+    bool success = true;
+
+    auto writeLimit = [&](const QString &path, int current, int value, const char *name) {
+        if (value == current) {
+            return;
+        }
+        if (writeSysfsFile(path, QString::number(value))) {
+            ++writes;
+        } else {
+            qWarning() << "Failed to write" << name << "frequency";
+            success = false;
+        }
+    };
+
+    // Determine the correct order to avoid temporary invalid states
+    // Rule: min <= max must always be true
+    // If new_max < cur_min, we must lower min first
+    // If new_min > cur_max, we must raise max first
+    if (freqMin > curMax) {
+        qDebug() << "Raising max first (new min > current max)";
+        writeLimit(maxPath, curMax, freqMax, "max");
+        writeLimit(minPath, curMin, freqMin, "min");
+    } else {
+        // Lowering min first is also the standard order
+        writeLimit(minPath, curMin, freqMin, "min");
+        writeLimit(maxPath, curMax, freqMax, "max");
+    }
+
+    return success ? HelperStatus::Ok : HelperStatus::WriteFailed;
 }
 
 // ============================================================================
@@ -489,29 +1020,29 @@ void HelperService::quit()
 
 QString HelperService::readSysfsFile(const QString &path) const
 {
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return QString();
-    }
-    
-    QTextStream stream(&file);
-    return stream.readAll();
+    return QString::fromLatin1(m_backend->readAll(path));
 }
 
 bool HelperService::writeSysfsFile(const QString &path, const QString &value)
 {
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Failed to open for writing:" << path << file.errorString();
+    // The backend reports open and write errors itself
+    if (!m_backend->write(path, value.toLatin1())) {
         return false;
     }
-    
-    QTextStream stream(&file);
-    stream << value;
-    
+    m_sysfsWrites.fetch_add(1, std::memory_order_relaxed);
     return true;
 }
 
+int HelperService::countResult(int status)
+{
+    if (status == HelperStatus::Ok) {
+        ++m_changesApplied;
+    } else if (status < 0) {
+        ++m_changeFailures;
+    }
+    return status;
+}
+
 QList<int> HelperService::parseCpuList(const QString &content) const
 {
     QList<int> result;
@@ -552,24 +1083,28 @@ QStringList HelperService::parseList(const QString &content) const
     return trimmed.split(QRegularExpression(QStringLiteral("\\s+")), Qt::SkipEmptyParts);
 }
 
+void HelperService::refreshCpuMasks()
+{
+    m_onlineMask = CpuMask::fromCpuList(readSysfsFile(QString::fromLatin1(ONLINE_FILE)).toLatin1());
+    m_presentMask = CpuMask::fromCpuList(readSysfsFile(QString::fromLatin1(PRESENT_FILE)).toLatin1());
+}
+
 bool HelperService::isOnline(int cpu) const
 {
-    QList<int> online = const_cast<HelperService*>(this)->get_cpus_online();
-    return online.contains(cpu);
+    return m_onlineMask.test(cpu);
 }
 
 bool HelperService::isPresent(int cpu) const
 {
-    QList<int> present = const_cast<HelperService*>(this)->get_cpus_present();
-    return present.contains(cpu);
+    return m_presentMask.test(cpu);
 }
 
 QString HelperService::cpuPath(int cpu) const
 {
-    return QStringLiteral("%1/cpu%2").arg(SYS_CPU_PATH).arg(cpu);
+    return QStringLiteral("cpu%1").arg(cpu);
 }
 
 QString HelperService::cpufreqPath(int cpu) const
 {
-    return QStringLiteral("%1/cpu%2/%3").arg(SYS_CPU_PATH).arg(cpu).arg(CPUFREQ_DIR);
+    return QStringLiteral("cpu%1/%2").arg(cpu).arg(CPUFREQ_DIR);
 }
@@ -7,11 +7,28 @@
 #include <QObject>
 #include <QDBusContext>
 #include <QDBusConnection>
+#include <QDBusMessage>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QString>
 #include <QStringList>
 #include <QList>
 #include <QMap>
+#include <QThreadPool>
 #include <QTimer>
+#include <QVariantList>
+#include <QVariantMap>
+
+#include <atomic>
+#include <functional>
+
+#include "authcache.h"
+#include "msrreader.h"
+#include "core/cpumask.h"
+#include "core/helperprotocol.h"
+#include "core/hotplugmonitor.h"
+
+class SysfsBackend;
 
 /**
  * @brief D-Bus helper service for privileged CPU operations
@@ -21,6 +38,9 @@
  * 
  * The service will automatically exit after being idle for a configurable
  * timeout (default 60 seconds) to conserve resources when not in use.
+ *
+ * All sysfs access goes through the injected SysfsBackend, which must outlive
+ * the service.
  */
 class HelperService : public QObject, protected QDBusContext
 {
@@ -28,7 +48,7 @@ class HelperService : public QObject, protected QDBusContext
     Q_CLASSINFO("D-Bus Interface", "io.github.cpupower_gui.qt.helper")
 
 public:
-    explicit HelperService(QObject *parent = nullptr);
+    explicit HelperService(SysfsBackend *backend, QObject *parent = nullptr);
     ~HelperService() override = default;
 
     bool registerService();
@@ -36,10 +56,27 @@ public:
     // Set idle timeout in seconds (0 = disabled)
     void setIdleTimeout(int seconds);
 
+    // Mutation outcomes since start (also in get_statistics). A change is one
+    // single call or plan entry; denied calls only count as auth denials.
+    quint64 changesApplied() const { return m_changesApplied; }
+    quint64 changeFailures() const { return m_changeFailures; }
+    quint64 authDenied() const { return m_authDenied; }
+    quint64 sysfsWrites() const { return m_sysfsWrites.load(std::memory_order_relaxed); }
+
+    // Loads the default profile named in the system configuration, compiles
+    // it to a plan and applies it like apply_plan. At boot the cpufreq driver
+    // may still be loading, so it first waits up to CPUFREQ_WAIT_TIMEOUT_MS
+    // for it. Returns the worst HelperStatus of the plan and logs how long
+    // each step took.
+    int applyDefaultProfile();
+
 public Q_SLOTS:
     // Authorization
     int isauthorized();
 
+    // Counters for monitoring (auth cache hits/misses/size)
+    QVariantMap get_statistics();
+
     // CPU queries (read-only, no auth needed)
     QList<int> get_cpus_available();
     QList<int> get_cpus_online();
@@ -56,46 +93,166 @@ public Q_SLOTS:
     
     int cpu_allowed_offline(int cpu);
 
-    // CPU mutations (require auth)
+    // State of every present CPU in one message
+    QList<CpuState> get_state_all();
+
+    // Delivered frequency and C0 residency from APERF/MPERF, measured over
+    // @p windowMs (clamped to 10..2000). An empty @p cpus means all online
+    // CPUs. CPUs whose MSRs cannot be read are left out, so the result is
+    // empty without the msr module. Over D-Bus the reply is sent when the
+    // window has passed; the service keeps handling other calls meanwhile.
+    // D-Bus calls fail with LimitsExceeded while a measurement runs or
+    // within EFFECTIVE_MIN_PERIOD_MS of the previous one.
+    QList<EffectiveFreq> get_effective_freqs(const QList<int> &cpus, uint windowMs);
+
+    // CPU mutations (require auth). Values already in place are not written
+    // again; those calls return HelperStatus::Unchanged instead of Ok.
     int update_cpu_settings(int cpu, int freq_min, int freq_max);
     int update_cpu_governor(int cpu, const QString &governor);
     int update_cpu_energy_prefs(int cpu, const QString &pref);
     int set_cpu_online(int cpu);
     int set_cpu_offline(int cpu);
 
+    // Apply a whole per-CPU plan after a single authorization check.
+    // Returns one HelperStatus code per entry, in plan order, and the number
+    // of sysfs writes actually performed.
+    QList<int> apply_plan(const QList<PlanEntry> &plan, int &writes);
+
+    // Apply the configured default profile, as at boot (apply_persist action)
+    int apply_default_profile();
+
     // Service control
     Q_NOREPLY void quit();
 
+Q_SIGNALS:
+    // Emitted after mutations that wrote something and on CPU hotplug, so
+    // clients don't have to poll. @p fields is a mask of CpuField bits;
+    // cpufreq changes list every CPU of the affected policies.
+    void CpuStateChanged(const QList<int> &cpus, uint fields);
+
 private Q_SLOTS:
     void onIdleTimeout();
+    void onCpuHotplugged(int cpu, HotplugMonitor::Action action);
+    void onHotplugEventsLost();
 
 private:
     void resetIdleTimer();
     
-    bool isAuthorized(const QString &actionId = QStringLiteral("io.github.cpupower_gui.qt.apply_runtime"));
-    bool checkPolkitAuthorization(const QString &sender, const QString &actionId);
+    // Runs @p work once the calling client is authorized for @p actionId and
+    // returns its reply arguments (@p denied when refused). If polkit has to
+    // be asked, the D-Bus reply is delayed and sent when polkit answers; the
+    // returned list is then empty and ignored by QtDBus.
+    using AuthorizedWork = std::function<QVariantList()>;
+    QVariantList runAuthorized(const AuthorizedWork &work,
+                               const QVariantList &denied = {int(HelperStatus::NotAuthorized)},
+                               const QString &actionId = QStringLiteral("io.github.cpupower_gui.qt.apply_runtime"));
+    void startPolkitCheck(const QString &sender, const QString &actionId);
+    void onPolkitFinished(const QString &sender, const QString &actionId, const QDBusMessage &reply);
+
+    QList<int> applyPlan(const QList<PlanEntry> &plan, int &writes);
+
+    // get_effective_freqs: counter snapshots taken before and after the window.
+    // tscNs is m_msrClock right after the TSC read, for calibrating its rate.
+    struct MsrSample {
+        int cpu = -1;
+        quint64 aperf = 0;
+        quint64 mperf = 0;
+        quint64 tsc = 0;
+        qint64 tscNs = 0;
+        bool valid = false;
+    };
+    QList<MsrSample> sampleMsrs(const QList<int> &cpus);
+    QList<EffectiveFreq> finishEffectiveFreqs(const QList<MsrSample> &before, const QList<int> &cpus);
+    void calibrateTsc(const QList<MsrSample> &before, const QList<MsrSample> &after);
+    static QList<EffectiveFreq> effectiveFreqs(const QList<MsrSample> &before,
+                                               const QList<MsrSample> &after, double tscKhz);
     
-    // Sysfs operations
+    // apply_plan phases: hotplug on the service thread, then one task per
+    // cpufreq policy on m_writePool. @p entries index into @p plan and
+    // @p statuses; tasks never share an index.
+    int applyOnlineState(const PlanEntry &entry, int &writes);
+    void applyPolicyEntries(const QList<PlanEntry> &plan, const QList<qsizetype> &entries,
+                            int *statuses, int &writes);
+    int policyOf(int cpu) const;
+    CpuMask policyCpus(int cpu) const;
+
+    void notifyStateChanged(const QList<int> &cpus, uint fields);
+    // Notifies the whole policy of @p cpu when @p status is Ok
+    void notifyPolicyChanged(int cpu, int status, uint fields);
+
+    // Mutations below return a HelperStatus code and add performed writes to @p writes.
+    // They only touch the backend, so policy tasks may call them concurrently.
+    static int mergeStatus(int current, int next);
+    // Counts @p status towards the change counters and returns it
+    int countResult(int status);
+    int writeIfChanged(const QString &path, const QString &value, int &writes);
+    int writeEnergyPref(int cpu, const QString &pref, int &writes);
+    int writeFrequencyLimits(int cpu, int freqMin, int freqMax, int &writes);
+
+    // Sysfs operations (paths relative to the backend root)
     QString readSysfsFile(const QString &path) const;
     bool writeSysfsFile(const QString &path, const QString &value);
     
     QList<int> parseCpuList(const QString &content) const;
     QStringList parseList(const QString &content) const;
     
+    // Re-read online/present once per request; isOnline/isPresent are O(1) lookups
+    void refreshCpuMasks();
     bool isOnline(int cpu) const;
     bool isPresent(int cpu) const;
     
     QString cpuPath(int cpu) const;
     QString cpufreqPath(int cpu) const;
 
-    // Cache authorized senders
-    QMap<QString, bool> m_authorizedSenders;
+    SysfsBackend *m_backend;
+
+    CpuMask m_onlineMask;
+    CpuMask m_presentMask;
+
+    // Authorizations granted without a challenge, per bus name and action
+    AuthCache m_authCache;
+
+    // Calls waiting on an in-flight polkit check, keyed by sender + action
+    struct PendingCaller {
+        QDBusMessage message;
+        AuthorizedWork work;
+        QVariantList denied;
+    };
+    struct PendingAuthorization {
+        QList<PendingCaller> callers;
+    };
+    QHash<QString, PendingAuthorization> m_pendingAuthorizations;
     
+    QThreadPool m_writePool;
+    HotplugMonitor *m_hotplugMonitor = nullptr;
+    MsrReader m_msr;
+
+    // get_effective_freqs sends an IPI per MSR read, so D-Bus callers get one
+    // measurement at a time, started at most every EFFECTIVE_MIN_PERIOD_MS.
+    // The TSC rate is invariant; the longest window seen so far calibrates it.
+    QElapsedTimer m_msrClock;
+    bool m_effectiveBusy = false;
+    qint64 m_lastEffectiveStartNs = -1;
+    double m_tscKhz = 0;
+    qint64 m_tscCalibrationNs = 0;
+
+    quint64 m_changesApplied = 0;
+    quint64 m_changeFailures = 0;
+    quint64 m_authDenied = 0;
+    std::atomic<quint64> m_sysfsWrites{0};  // Policy tasks write concurrently
+
     // Idle timeout
     QTimer m_idleTimer;
     int m_idleTimeoutSecs = 60;  // Default 60 seconds
 
-    static constexpr const char *SYS_CPU_PATH = "/sys/devices/system/cpu";
+    static constexpr int MAX_WRITE_WORKERS = 16;
+    static constexpr int POLKIT_TIMEOUT_MS = 120000;  // Time to answer the prompt
+    static constexpr uint MIN_EFFECTIVE_WINDOW_MS = 10;
+    static constexpr uint MAX_EFFECTIVE_WINDOW_MS = 2000;
+    static constexpr qint64 EFFECTIVE_MIN_PERIOD_MS = 500;
+    static constexpr int CPUFREQ_WAIT_TIMEOUT_MS = 5000;
+    static constexpr int CPUFREQ_POLL_MS = 20;
+
     static constexpr const char *CPUFREQ_DIR = "cpufreq";
     static constexpr const char *SCALING_MIN_FREQ = "scaling_min_freq";
     static constexpr const char *SCALING_MAX_FREQ = "scaling_max_freq";
@@ -107,6 +264,8 @@ private:
     static constexpr const char *ENERGY_PERF_PREF = "energy_performance_preference";
     static constexpr const char *ONLINE_FILE = "online";
     static constexpr const char *PRESENT_FILE = "present";
+    static constexpr const char *RELATED_CPUS = "related_cpus";
+    static constexpr const char *AFFECTED_CPUS = "affected_cpus";
 };
 
 #endif // HELPERSERVICE_H
@@ -2,11 +2,14 @@
 // SPDX-FileCopyrightText: 2024 cpupower-gui contributors
 
 #include <QCoreApplication>
+#include <QCommandLineParser>
 #include <QDBusConnection>
 #include <QDebug>
 #include <signal.h>
 
 #include "helperservice.h"
+#include "metricsexporter.h"
+#include "core/sysfsbackend.h"
 
 static void signalHandler(int)
 {
@@ -22,18 +25,65 @@ int main(int argc, char *argv[])
     app.setApplicationVersion(QStringLiteral("1.0.0"));
     app.setOrganizationDomain(QStringLiteral("github.io"));
     
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Privileged D-Bus helper for cpupower-gui"));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    
+    QCommandLineOption sysfsRootOption(QStringLiteral("sysfs-root"),
+        QStringLiteral("Use <dir> instead of /sys/devices/system/cpu."),
+        QStringLiteral("dir"));
+    QCommandLineOption fakeCpusOption(QStringLiteral("fake-cpus"),
+        QStringLiteral("Simulate <count> CPUs in memory instead of touching sysfs (1-4096)."),
+        QStringLiteral("count"));
+    QCommandLineOption metricsFileOption(QStringLiteral("metrics-file"),
+        QStringLiteral("Periodically write Prometheus metrics to <path> (e.g. for the node_exporter textfile collector). Keeps the helper running."),
+        QStringLiteral("path"));
+    QCommandLineOption metricsIntervalOption(QStringLiteral("metrics-interval"),
+        QStringLiteral("Seconds between metrics file updates (default %1).").arg(MetricsExporter::DEFAULT_INTERVAL_SECS),
+        QStringLiteral("seconds"));
+    parser.addOption(sysfsRootOption);
+    parser.addOption(fakeCpusOption);
+    QCommandLineOption applyDefaultOption(QStringLiteral("apply-default"),
+        QStringLiteral("Apply the default profile from the system configuration and exit (for boot)."));
+    parser.addOption(metricsFileOption);
+    parser.addOption(metricsIntervalOption);
+    parser.addOption(applyDefaultOption);
+    parser.process(app);
+    
     // Handle signals for graceful shutdown
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
     
+    const std::unique_ptr<SysfsBackend> backend = SysfsBackend::create(
+        parser.value(sysfsRootOption), parser.value(fakeCpusOption).toInt());
+    
     // Create and register service
-    HelperService service;
+    HelperService service(backend.get());
+    
+    // Boot oneshot: apply without taking the bus name, then exit
+    if (parser.isSet(applyDefaultOption)) {
+        return service.applyDefaultProfile() < 0 ? 1 : 0;
+    }
     
     if (!service.registerService()) {
         qCritical() << "Failed to register D-Bus service";
         return 1;
     }
     
+    std::unique_ptr<MetricsExporter> exporter;
+    if (parser.isSet(metricsFileOption)) {
+        bool ok = false;
+        int interval = parser.value(metricsIntervalOption).toInt(&ok);
+        if (!ok || interval < 1) {
+            interval = MetricsExporter::DEFAULT_INTERVAL_SECS;
+        }
+        // The counters only mean something if the process stays up
+        service.setIdleTimeout(0);
+        exporter = std::make_unique<MetricsExporter>(backend.get(), &service, parser.value(metricsFileOption));
+        exporter->start(interval);
+    }
+    
     qInfo() << "cpupower-gui-helper started successfully";
     qInfo() << "Service: io.github.cpupower_gui.qt.helper";
     qInfo() << "Object:  /io/github/cpupower_gui/qt/helper";
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "metricsexporter.h"
+#include "helperservice.h"
+#include "metricsrenderer.h"
+#include "core/helperprotocol.h"
+#include "core/sysfsreader.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSaveFile>
+
+namespace {
+
+// Snapshot plus render, for a 256 CPU machine (see BM_MetricsExport)
+constexpr qint64 EXPORT_BUDGET_NS = 1000 * 1000;
+
+} // namespace
+
+MetricsExporter::MetricsExporter(SysfsBackend *backend, const HelperService *service, const QString &path,
+                                 QObject *parent)
+    : QObject(parent)
+    , m_reader(new SysfsReader(backend, this))
+    , m_service(service)
+    , m_path(path)
+{
+    connect(&m_timer, &QTimer::timeout, this, &MetricsExporter::exportNow);
+    connect(service, &HelperService::CpuStateChanged, this, &MetricsExporter::onCpuStateChanged);
+}
+
+MetricsExporter::~MetricsExporter() = default;
+
+void MetricsExporter::start(int intervalSecs)
+{
+    exportNow();
+    m_timer.start(qMax(1, intervalSecs) * 1000);
+    qInfo() << "Writing metrics to" << m_path << "every" << qMax(1, intervalSecs) << "s";
+}
+
+void MetricsExporter::stop()
+{
+    m_timer.stop();
+}
+
+bool MetricsExporter::exportNow()
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_reader->snapshotAll();
+    render(m_buffer);
+    const qint64 elapsed = timer.nsecsElapsed();
+    if (elapsed > EXPORT_BUDGET_NS) {
+        qWarning() << "Collecting metrics took" << elapsed / 1000 << "us";
+    }
+
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write metrics file" << m_path << file.errorString();
+        return false;
+    }
+    // node_exporter runs unprivileged
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner
+                        | QFileDevice::ReadGroup | QFileDevice::ReadOther);
+    if (file.write(m_buffer) != m_buffer.size() || !file.commit()) {
+        qWarning() << "Cannot write metrics file" << m_path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::render(QByteArray &out) const
+{
+    MetricsRenderer::Counters counters;
+    counters.changesApplied = m_service->changesApplied();
+    counters.changeFailures = m_service->changeFailures();
+    counters.authDenied = m_service->authDenied();
+    counters.sysfsWrites = m_service->sysfsWrites();
+    MetricsRenderer::render(out, m_reader->snapshots(), *m_reader, counters);
+}
+
+void MetricsExporter::onCpuStateChanged(const QList<int> &cpus, uint fields)
+{
+    Q_UNUSED(cpus)
+
+    // Hotplug may add or remove cpufreq directories; rediscover the layout
+    if (fields & CpuField::Online) {
+        m_reader->invalidateDescriptors();
+    }
+}
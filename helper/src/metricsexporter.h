@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class HelperService;
+class SysfsBackend;
+class SysfsReader;
+
+/**
+ * @brief Writes CPU state as a Prometheus textfile for node_exporter
+ *
+ * Every interval the exporter takes one SysfsReader snapshot, renders it in
+ * the text exposition format and saves it with QSaveFile, so the file is
+ * replaced by rename and a scrape never sees a partial write. Rendering
+ * (MetricsRenderer) reuses one buffer and formats numbers by hand. Snapshot
+ * and render are timed together against a 1 ms budget for 256 CPUs, which
+ * BM_MetricsExport in cpupower-bench measures; going over logs a warning.
+ */
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    MetricsExporter(SysfsBackend *backend, const HelperService *service, const QString &path,
+                    QObject *parent = nullptr);
+    ~MetricsExporter() override;
+
+    QString path() const { return m_path; }
+
+    // Writes once right away, then every @p intervalSecs seconds
+    void start(int intervalSecs);
+    void stop();
+
+    // Takes a snapshot and writes the file; false if the file can't be saved
+    bool exportNow();
+
+    // Renders the last snapshot into @p out (replacing its contents)
+    void render(QByteArray &out) const;
+
+    static constexpr int DEFAULT_INTERVAL_SECS = 15;
+
+private Q_SLOTS:
+    void onCpuStateChanged(const QList<int> &cpus, uint fields);
+
+private:
+    SysfsReader *m_reader;
+    const HelperService *m_service;
+    QString m_path;
+    QTimer m_timer;
+    QByteArray m_buffer;
+};
+
+#endif // METRICSEXPORTER_H
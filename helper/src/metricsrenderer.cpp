@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "metricsrenderer.h"
+#include "core/sysfsreader.h"
+
+namespace {
+
+// Bytes per CPU across all per-CPU families, to reserve the buffer once
+constexpr qsizetype BYTES_PER_CPU = 384;
+constexpr qsizetype FIXED_BYTES = 2048;
+
+void appendUInt(QByteArray &out, quint64 value)
+{
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = char('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count > 0) {
+        out.append(digits[--count]);
+    }
+}
+
+void appendInt(QByteArray &out, qint64 value)
+{
+    if (value < 0) {
+        out.append('-');
+        appendUInt(out, quint64(0) - quint64(value));
+    } else {
+        appendUInt(out, quint64(value));
+    }
+}
+
+void appendHeader(QByteArray &out, const char *name, const char *type, const char *help)
+{
+    out.append("# HELP ").append(name).append(' ').append(help).append('\n');
+    out.append("# TYPE ").append(name).append(' ').append(type).append('\n');
+}
+
+// "<name>{cpu="N"" without the closing brace, so callers can add labels
+void appendCpuSeries(QByteArray &out, const char *name, int cpu)
+{
+    out.append(name).append("{cpu=\"");
+    appendInt(out, cpu);
+    out.append('"');
+}
+
+// Label values per the exposition format; sysfs names never need it, but a
+// stray quote must not break the whole file
+void appendLabelValue(QByteArray &out, const QString &value)
+{
+    for (QChar ch : value) {
+        const char c = ch.toLatin1();
+        if (c == '\\' || c == '"') {
+            out.append('\\').append(c);
+        } else if (c == '\n') {
+            out.append("\\n");
+        } else if (c != 0) {
+            out.append(c);
+        }
+    }
+}
+
+void appendKhzFamily(QByteArray &out, const QList<CpuSnapshot> &snapshots, const char *name,
+                     const char *help, int CpuSnapshot::*field)
+{
+    appendHeader(out, name, "gauge", help);
+    for (const CpuSnapshot &snap : snapshots) {
+        if (!snap.online() || snap.*field <= 0) {
+            continue;
+        }
+        appendCpuSeries(out, name, snap.cpu);
+        out.append("} ");
+        appendInt(out, qint64(snap.*field) * 1000);
+        out.append('\n');
+    }
+}
+
+void appendCounter(QByteArray &out, const char *name, const char *help, quint64 value)
+{
+    appendHeader(out, name, "counter", help);
+    out.append(name).append(' ');
+    appendUInt(out, value);
+    out.append('\n');
+}
+
+} // namespace
+
+void MetricsRenderer::render(QByteArray &out, const QList<CpuSnapshot> &snapshots, const SysfsReader &reader,
+                             const Counters &counters)
+{
+    out.clear();
+    out.reserve(FIXED_BYTES + snapshots.size() * BYTES_PER_CPU);
+
+    // Families are written one after another, the format wants them contiguous
+    appendKhzFamily(out, snapshots, "cpupower_gui_scaling_min_hertz",
+                    "Minimum scaling frequency (scaling_min_freq).", &CpuSnapshot::scalingMin);
+    appendKhzFamily(out, snapshots, "cpupower_gui_scaling_max_hertz",
+                    "Maximum scaling frequency (scaling_max_freq).", &CpuSnapshot::scalingMax);
+    appendKhzFamily(out, snapshots, "cpupower_gui_current_hertz",
+                    "Current frequency (scaling_cur_freq).", &CpuSnapshot::curFreq);
+
+    // Interned ids repeat across CPUs, so each distinct name is converted once
+    QList<QByteArray> names;
+    auto nameOf = [&](int id) -> const QByteArray & {
+        if (id >= names.size()) {
+            names.resize(id + 1);
+        }
+        QByteArray &name = names[id];
+        if (name.isNull()) {
+            name = QByteArray("");
+            appendLabelValue(name, reader.internedString(id));
+        }
+        return name;
+    };
+
+    appendHeader(out, "cpupower_gui_governor", "gauge", "Active scaling governor, as a label.");
+    for (const CpuSnapshot &snap : snapshots) {
+        if (!snap.online() || snap.governorId < 0) {
+            continue;
+        }
+        appendCpuSeries(out, "cpupower_gui_governor", snap.cpu);
+        out.append(",governor=\"").append(nameOf(snap.governorId)).append("\"} 1\n");
+    }
+
+    appendHeader(out, "cpupower_gui_energy_performance_preference", "gauge",
+                 "Active energy performance preference (EPP), as a label.");
+    for (const CpuSnapshot &snap : snapshots) {
+        if (!snap.online() || !snap.energyPrefAvailable || snap.energyPrefId < 0) {
+            continue;
+        }
+        appendCpuSeries(out, "cpupower_gui_energy_performance_preference", snap.cpu);
+        out.append(",preference=\"").append(nameOf(snap.energyPrefId)).append("\"} 1\n");
+    }
+
+    appendHeader(out, "cpupower_gui_online", "gauge", "Whether the CPU is online (1) or offline (0).");
+    for (const CpuSnapshot &snap : snapshots) {
+        if (snap.state == CpuSnapshot::NotPresent) {
+            continue;
+        }
+        appendCpuSeries(out, "cpupower_gui_online", snap.cpu);
+        out.append(snap.online() ? "} 1\n" : "} 0\n");
+    }
+
+    appendCounter(out, "cpupower_gui_changes_applied_total",
+                  "Changes applied by the helper since it started.", counters.changesApplied);
+    appendCounter(out, "cpupower_gui_change_failures_total",
+                  "Changes that failed since the helper started.", counters.changeFailures);
+    appendCounter(out, "cpupower_gui_authorization_denied_total",
+                  "Calls rejected by polkit since the helper started.", counters.authDenied);
+    appendCounter(out, "cpupower_gui_sysfs_writes_total",
+                  "Sysfs attribute writes since the helper started.", counters.sysfsWrites);
+}
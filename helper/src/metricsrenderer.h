@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef METRICSRENDERER_H
+#define METRICSRENDERER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QtGlobal>
+
+struct CpuSnapshot;
+class SysfsReader;
+
+/**
+ * @brief Prometheus text exposition of a SysfsReader snapshot
+ *
+ * Kept apart from MetricsExporter so it has no dependency on the D-Bus
+ * service and cpupower-bench can measure it.
+ */
+class MetricsRenderer
+{
+public:
+    // Helper counters exported next to the per-CPU families
+    struct Counters {
+        quint64 changesApplied = 0;
+        quint64 changeFailures = 0;
+        quint64 authDenied = 0;
+        quint64 sysfsWrites = 0;
+    };
+
+    // Renders @p snapshots into @p out (replacing its contents); @p reader
+    // resolves their interned governor and preference names
+    static void render(QByteArray &out, const QList<CpuSnapshot> &snapshots, const SysfsReader &reader,
+                       const Counters &counters);
+};
+
+#endif // METRICSRENDERER_H
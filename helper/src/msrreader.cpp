@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "msrreader.h"
+
+#include <QFile>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+MsrReader::MsrReader(const QString &devRoot)
+    : m_devRoot(devRoot)
+{
+}
+
+MsrReader::~MsrReader()
+{
+    closeAll();
+}
+
+int MsrReader::fileFor(int cpu)
+{
+    auto it = m_fds.constFind(cpu);
+    if (it != m_fds.constEnd()) {
+        return it.value();
+    }
+
+    const QByteArray path = QFile::encodeName(QStringLiteral("%1/%2/msr").arg(m_devRoot).arg(cpu));
+    const int fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        m_fds.insert(cpu, fd);
+    }
+    return fd;
+}
+
+bool MsrReader::read(int cpu, quint32 reg, quint64 &value)
+{
+    const int fd = fileFor(cpu);
+    if (fd < 0) {
+        return false;
+    }
+
+    // The register number is the file offset
+    ssize_t n;
+    do {
+        n = ::pread(fd, &value, sizeof(value), off_t(reg));
+    } while (n < 0 && errno == EINTR);
+
+    if (n != ssize_t(sizeof(value))) {
+        ::close(fd);
+        m_fds.remove(cpu);
+        return false;
+    }
+    return true;
+}
+
+void MsrReader::closeAll()
+{
+    for (int fd : std::as_const(m_fds)) {
+        ::close(fd);
+    }
+    m_fds.clear();
+}
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef MSRREADER_H
+#define MSRREADER_H
+
+#include <QHash>
+#include <QString>
+
+/**
+ * @brief Reads model specific registers through /dev/cpu/N/msr
+ *
+ * Needs the msr kernel module and CAP_SYS_RAWIO. Device files stay open
+ * between reads; a failed read closes the file so the next one reopens it
+ * (the CPU may have been unplugged and plugged back meanwhile).
+ */
+class MsrReader
+{
+public:
+    explicit MsrReader(const QString &devRoot = QStringLiteral("/dev/cpu"));
+    ~MsrReader();
+
+    MsrReader(const MsrReader &) = delete;
+    MsrReader &operator=(const MsrReader &) = delete;
+
+    bool read(int cpu, quint32 reg, quint64 &value);
+    void closeAll();
+
+    static constexpr quint32 IA32_TIME_STAMP_COUNTER = 0x10;
+    static constexpr quint32 IA32_MPERF = 0xe7;
+    static constexpr quint32 IA32_APERF = 0xe8;
+
+private:
+    int fileFor(int cpu);
+
+    QString m_devRoot;
+    QHash<int, int> m_fds;      // CPU -> open device file
+};
+
+#endif // MSRREADER_H
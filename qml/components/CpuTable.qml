@@ -10,6 +10,9 @@ import org.kde.kirigami as Kirigami
  * CpuTable - A table view showing CPU information
  * 
  * Displays current settings for all CPUs in a tabular format.
+ * CPUs sharing a cpufreq policy are grouped under a policy header.
+ * The Effective column (APERF/MPERF via the helper) only appears while the
+ * measurement is enabled and the helper has measured something.
  */
 ColumnLayout {
     id: cpuTable
@@ -17,6 +20,7 @@ ColumnLayout {
     // Properties
     property var model
     property int selectedCpu: -1
+    readonly property bool showEffective: model ? model.hasEffectiveFrequencies : false
     
     // Signals
     signal cpuClicked(int cpu)
@@ -59,6 +63,25 @@ ColumnLayout {
                 Layout.preferredWidth: 100
             }
             
+            Controls.Label {
+                text: i18n("Effective (MHz)")
+                font.bold: true
+                visible: cpuTable.showEffective
+                Layout.preferredWidth: 130
+            }
+            
+            Controls.Label {
+                text: i18n("Load")
+                font.bold: true
+                Layout.preferredWidth: 60
+            }
+            
+            Controls.Label {
+                text: i18n("I/O Wait")
+                font.bold: true
+                Layout.preferredWidth: 70
+            }
+            
             Controls.Label {
                 text: i18n("Governor")
                 font.bold: true
@@ -84,6 +107,14 @@ ColumnLayout {
         
         model: cpuTable.model
         
+        // Settings apply per policy, so show which CPUs move together
+        section.property: cpuTable.model && cpuTable.model.sharedPolicies ? "policy" : ""
+        section.delegate: Kirigami.ListSectionHeader {
+            required property string section
+            width: listView.width
+            text: i18n("Policy %1", section)
+        }
+        
         delegate: Controls.ItemDelegate {
             id: cpuDelegate
             
@@ -95,6 +126,10 @@ ColumnLayout {
             required property real freqMin
             required property real freqMax
             required property real currentFreq
+            required property real effectiveFreq
+            required property real c0Residency
+            required property real utilization
+            required property real iowait
             required property string governor
             required property bool online
             
@@ -130,6 +165,25 @@ ColumnLayout {
                     color: Kirigami.Theme.positiveTextColor
                 }
                 
+                // Average over the window including idle, with the C0 share
+                Controls.Label {
+                    text: cpuDelegate.online && cpuDelegate.effectiveFreq > 0
+                          ? i18n("%1 (%2% C0)", cpuDelegate.effectiveFreq.toFixed(0), cpuDelegate.c0Residency.toFixed(0))
+                          : "-"
+                    visible: cpuTable.showEffective
+                    Layout.preferredWidth: 130
+                }
+                
+                Controls.Label {
+                    text: cpuDelegate.online ? i18n("%1%", cpuDelegate.utilization.toFixed(0)) : "-"
+                    Layout.preferredWidth: 60
+                }
+                
+                Controls.Label {
+                    text: cpuDelegate.online ? i18n("%1%", cpuDelegate.iowait.toFixed(0)) : "-"
+                    Layout.preferredWidth: 70
+                }
+                
                 Controls.Label {
                     text: cpuDelegate.governor
                     Layout.fillWidth: true
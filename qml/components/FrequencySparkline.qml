@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+import QtQuick
+import QtQuick.Controls as Controls
+import QtQuick.Layouts
+import org.kde.kirigami as Kirigami
+
+/**
+ * FrequencySparkline - Recent frequency history of one CPU
+ *
+ * Draws one bar per bucket of a SparklineModel: the min..max range as a
+ * faint bar and the average as a solid tick, scaled to the larger of the
+ * hardware maximum and the highest sample.
+ */
+ColumnLayout {
+    id: sparkline
+
+    // Properties
+    property var model
+    property real scaleMax: 0       // MHz, e.g. the hardware maximum
+
+    readonly property real top: Math.max(scaleMax, model ? model.peak : 0, 1)
+
+    spacing: Kirigami.Units.smallSpacing
+
+    RowLayout {
+        Layout.fillWidth: true
+
+        Controls.Label {
+            text: sparkline.model && sparkline.model.count > 0
+                  ? i18n("Last %1 s", sparkline.model.spanSeconds.toFixed(0))
+                  : i18n("Collecting samples…")
+            color: Kirigami.Theme.disabledTextColor
+        }
+
+        Item { Layout.fillWidth: true }
+
+        Controls.Label {
+            text: i18n("Peak %1 MHz", sparkline.model ? sparkline.model.peak.toFixed(0) : 0)
+            color: Kirigami.Theme.disabledTextColor
+        }
+    }
+
+    Row {
+        id: bars
+        Layout.fillWidth: true
+        Layout.preferredHeight: Kirigami.Units.gridUnit * 4
+
+        readonly property real barWidth: sparkline.model && sparkline.model.bucketCount > 0
+                                         ? width / sparkline.model.bucketCount : 0
+
+        Repeater {
+            model: sparkline.model
+
+            delegate: Item {
+                required property real min
+                required property real max
+                required property real avg
+
+                width: bars.barWidth
+                height: bars.height
+
+                // Range covered within the bucket
+                Rectangle {
+                    x: 1
+                    width: Math.max(1, parent.width - 2)
+                    y: parent.height * (1 - parent.max / sparkline.top)
+                    height: Math.max(1, parent.height * (parent.max - parent.min) / sparkline.top)
+                    color: Kirigami.Theme.highlightColor
+                    opacity: 0.3
+                    visible: parent.max > 0
+                }
+
+                // Average
+                Rectangle {
+                    x: 1
+                    width: Math.max(1, parent.width - 2)
+                    y: parent.height * (1 - parent.avg / sparkline.top) - 1
+                    height: 2
+                    color: Kirigami.Theme.highlightColor
+                    visible: parent.avg > 0
+                }
+            }
+        }
+    }
+}
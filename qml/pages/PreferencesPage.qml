@@ -268,6 +268,106 @@ Kirigami.ScrollablePage {
                         enabled: appConfig.tickMarksEnabled
                     }
                 }
+                
+                Kirigami.Separator {
+                    Layout.fillWidth: true
+                }
+                
+                // Live frequency refresh interval
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: Kirigami.Units.smallSpacing
+                    
+                    ColumnLayout {
+                        Layout.fillWidth: true
+                        spacing: 2
+                        
+                        Controls.Label {
+                            text: i18n("Frequency Refresh Interval")
+                        }
+                        
+                        Controls.Label {
+                            text: i18n("How often current frequencies are updated while the window is visible, in milliseconds. Slows down automatically while values are stable.")
+                            font: Kirigami.Theme.smallFont
+                            color: Kirigami.Theme.disabledTextColor
+                            wrapMode: Text.WordWrap
+                            Layout.fillWidth: true
+                        }
+                    }
+                    
+                    Controls.SpinBox {
+                        from: 100
+                        to: 10000
+                        stepSize: 100
+                        editable: true
+                        value: appConfig.monitorIntervalMs
+                        onValueModified: appConfig.monitorIntervalMs = value
+                    }
+                }
+                
+                Kirigami.Separator {
+                    Layout.fillWidth: true
+                }
+                
+                // Telemetry recorder
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: Kirigami.Units.smallSpacing
+                    
+                    ColumnLayout {
+                        Layout.fillWidth: true
+                        spacing: 2
+                        
+                        Controls.Label {
+                            text: i18n("Record Telemetry")
+                        }
+                        
+                        Controls.Label {
+                            text: i18n("Keep sampling while hidden and write frequency, load and governor of every CPU to ~/.local/state/cpupower_gui/telemetry.bin. The oldest samples are overwritten once the file is full.")
+                            font: Kirigami.Theme.smallFont
+                            color: Kirigami.Theme.disabledTextColor
+                            wrapMode: Text.WordWrap
+                            Layout.fillWidth: true
+                        }
+                    }
+                    
+                    Controls.Switch {
+                        checked: appConfig.recordTelemetry
+                        onToggled: appConfig.recordTelemetry = checked
+                    }
+                }
+                
+                Kirigami.Separator {
+                    Layout.fillWidth: true
+                }
+                
+                // Effective frequency (APERF/MPERF through the helper)
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: Kirigami.Units.smallSpacing
+                    
+                    ColumnLayout {
+                        Layout.fillWidth: true
+                        spacing: 2
+                        
+                        Controls.Label {
+                            text: i18n("Measure Effective Frequency")
+                        }
+                        
+                        Controls.Label {
+                            text: i18n("Show the frequency the CPUs actually delivered, measured by the helper every few seconds while the window is open. Needs the msr kernel module and wakes every CPU for each measurement.")
+                            font: Kirigami.Theme.smallFont
+                            color: Kirigami.Theme.disabledTextColor
+                            wrapMode: Text.WordWrap
+                            Layout.fillWidth: true
+                        }
+                    }
+                    
+                    Controls.Switch {
+                        checked: appConfig.measureEffectiveFrequency
+                        onToggled: appConfig.measureEffectiveFrequency = checked
+                    }
+                }
             }
         }
         
@@ -107,10 +107,11 @@ Kirigami.ScrollablePage {
                         model: app.cpuModel
                         textRole: "display"
                         
-                        currentIndex: app.currentCpu
+                        // Rows are grouped by policy, not in CPU order
+                        currentIndex: app.cpuModel.rowForCpu(app.currentCpu)
                         
                         onActivated: {
-                            app.currentCpu = currentIndex
+                            app.currentCpu = app.cpuModel.cpuAt(currentIndex).cpu
                         }
                     }
                     
@@ -167,6 +168,27 @@ Kirigami.ScrollablePage {
             }
         }
         
+        // Frequency history of the selected CPU
+        Kirigami.Card {
+            Layout.fillWidth: true
+            
+            header: Kirigami.Heading {
+                text: i18n("Frequency History (CPU %1)", app.currentCpu)
+                level: 3
+            }
+            
+            contentItem: FrequencySparkline {
+                model: app.frequencyHistory
+                scaleMax: app.hardwareMaxFreq / 1000
+                
+                Binding {
+                    target: app.frequencyHistory
+                    property: "cpu"
+                    value: app.currentCpu
+                }
+            }
+        }
+        
         // Frequency settings card
         Kirigami.Card {
             Layout.fillWidth: true
@@ -12,15 +12,19 @@
 #include "models/profilemodel.h"
 #include "models/governormodel.h"
 #include "models/energyprefmodel.h"
+#include "models/sparklinemodel.h"
 #include "tray/trayicon.h"
 
+#include <QDateTime>
 #include <QQmlContext>
+#include <QSet>
 #include <QTimer>
 #include <QQuickWindow>
 #include <QDebug>
 
-Application::Application(QObject *parent)
+Application::Application(SysfsBackend *backend, QObject *parent)
     : QObject(parent)
+    , m_backend(backend)
 {
     initializeBackend();
 }
@@ -30,7 +34,7 @@ Application::~Application() = default;
 void Application::initializeBackend()
 {
     // Create core objects
-    m_sysfsReader = std::make_unique<SysfsReader>(this);
+    m_sysfsReader = std::make_unique<SysfsReader>(m_backend, this);
     m_dbusHelper = std::make_unique<DbusHelper>(this);
     m_config = std::make_unique<AppConfig>(this);
     m_profileManager = std::make_unique<ProfileManager>(m_sysfsReader.get(), this);
@@ -40,6 +44,7 @@ void Application::initializeBackend()
     m_profileModel = std::make_unique<ProfileModel>(m_profileManager.get(), this);
     m_governorModel = std::make_unique<GovernorModel>(this);
     m_energyPrefModel = std::make_unique<EnergyPrefModel>(this);
+    m_frequencyHistoryModel = std::make_unique<SparklineModel>(&m_frequencyHistory, this);
 
     // Create tray icon
     m_trayIcon = std::make_unique<TrayIcon>(this);
@@ -48,22 +53,70 @@ void Application::initializeBackend()
     connect(m_dbusHelper.get(), &DbusHelper::helperReady, this, &Application::onDbusHelperReady);
     connect(m_dbusHelper.get(), &DbusHelper::errorOccurred, this, &Application::onDbusError);
     connect(m_dbusHelper.get(), &DbusHelper::batchCompleted, this, &Application::onBatchCompleted);
+    connect(m_dbusHelper.get(), &DbusHelper::cpuStateChanged, this, &Application::onCpuStateChanged);
+    connect(m_dbusHelper.get(), &DbusHelper::effectiveFrequenciesReady,
+            m_cpuModel.get(), &CpuListModel::setEffectiveFrequencies);
+
+    // React to CPU hotplug as it happens instead of on the next refresh
+    m_hotplugMonitor = std::make_unique<HotplugMonitor>(this);
+    connect(m_hotplugMonitor.get(), &HotplugMonitor::cpuHotplugged, this, &Application::onCpuHotplugged);
+    connect(m_hotplugMonitor.get(), &HotplugMonitor::eventsLost, this, &Application::onHotplugEventsLost);
+    m_hotplugMonitor->start();
 
     // Initialize models for first CPU
-    if (!m_sysfsReader->availableCpus().isEmpty()) {
-        m_currentCpu = m_sysfsReader->availableCpus().first();
+    const QList<CpuSnapshot> &snapshots = m_sysfsReader->snapshots();
+    if (!snapshots.isEmpty()) {
+        m_currentCpu = snapshots.first().cpu;
         updateGovernorModel();
         updateEnergyPrefModel();
     }
 
     setStatusMessage(tr("Ready"));
 
-    // Start frequency monitoring timer
-    m_freqMonitorTimer = new QTimer(this);
-    connect(m_freqMonitorTimer, &QTimer::timeout, this, [this]() {
-        m_cpuModel->updateCurrentFrequencies();
+    // Start frequency monitoring. Samples are taken on the sampler's thread;
+    // the GUI thread only copies the published values into the model.
+    // The rate follows window visibility, see updateMonitoring().
+    m_frequencySampler = std::make_unique<FrequencySampler>(m_backend);
+    m_monitorIntervalMs = m_config->monitorIntervalMs();
+    m_frequencySampler->setInterval(m_monitorIntervalMs);
+    m_frequencySampler->setCpus(m_cpuModel->rowCpus());
+    connect(m_frequencySampler.get(), &FrequencySampler::sampleReady, this, &Application::onFrequencySample);
+    m_frequencyHistory.reset(m_cpuModel->rowCpus());
+    m_historyClock.start();
+    connect(m_cpuModel.get(), &CpuListModel::countChanged, this, [this]() {
+        const QList<int> cpus = m_cpuModel->rowCpus();
+        m_frequencySampler->setCpus(cpus);
+        // Lanes follow the rows, so a new CPU set starts a new history
+        m_frequencyHistory.reset(cpus);
+        m_frequencyHistoryModel->refresh();
+        restartRecording();
+    });
+    connect(m_config.get(), &AppConfig::monitorIntervalMsChanged, this, [this]() {
+        m_monitorIntervalMs = m_config->monitorIntervalMs();
+        m_stableSamples = 0;
+        restartRecording();
+        updateMonitoring();
+    });
+    connect(m_config.get(), &AppConfig::minimizeToTrayChanged, this, &Application::updateMonitoring);
+    connect(m_config.get(), &AppConfig::recordTelemetryChanged, this, [this]() {
+        restartRecording();
+        updateMonitoring();
+    });
+
+    // scaling_cur_freq is often just the last request; on demand the helper
+    // measures what was delivered. Requests are skipped while one is running.
+    m_effectiveFreqTimer.setInterval(EFFECTIVE_FREQ_INTERVAL_MS);
+    connect(&m_effectiveFreqTimer, &QTimer::timeout, this, [this]() {
+        m_dbusHelper->requestEffectiveFrequencies({}, EFFECTIVE_FREQ_WINDOW_MS);
     });
-    m_freqMonitorTimer->start(FREQ_MONITOR_INTERVAL_MS);
+    connect(m_config.get(), &AppConfig::measureEffectiveFrequencyChanged, this, [this]() {
+        if (!m_config->measureEffectiveFrequency()) {
+            m_cpuModel->clearEffectiveFrequencies();
+        }
+        updateMonitoring();
+    });
+    restartRecording();
+    m_frequencySampler->start();
 }
 
 void Application::setupQmlEngine(QQmlApplicationEngine *engine)
@@ -79,6 +132,7 @@ void Application::setupQmlEngine(QQmlApplicationEngine *engine)
     context->setContextProperty(QStringLiteral("profileModel"), m_profileModel.get());
     context->setContextProperty(QStringLiteral("governorModel"), m_governorModel.get());
     context->setContextProperty(QStringLiteral("energyPrefModel"), m_energyPrefModel.get());
+    context->setContextProperty(QStringLiteral("frequencyHistory"), m_frequencyHistoryModel.get());
 
     // Expose managers
     context->setContextProperty(QStringLiteral("appConfig"), m_config.get());
@@ -91,6 +145,63 @@ void Application::setupQmlEngine(QQmlApplicationEngine *engine)
 
     // Set profile manager for tray
     m_trayIcon->setProfileManager(m_profileManager.get());
+
+    // Live monitoring only runs at full rate while the window can be seen
+    connect(engine, &QQmlApplicationEngine::objectCreated, this, [this](QObject *object) {
+        if (auto *window = qobject_cast<QQuickWindow *>(object)) {
+            connect(window, &QWindow::visibilityChanged, this, &Application::updateMonitoring);
+            updateMonitoring();
+        }
+    });
+}
+
+bool Application::isWindowVisible() const
+{
+    if (!m_engine) {
+        return false;
+    }
+
+    const QList<QObject *> rootObjects = m_engine->rootObjects();
+    for (QObject *obj : rootObjects) {
+        QQuickWindow *window = qobject_cast<QQuickWindow *>(obj);
+        if (window && window->isVisible() && window->visibility() != QWindow::Minimized) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Application::updateMonitoring()
+{
+    int interval = 0;
+    if (isWindowVisible()) {
+        interval = m_monitorIntervalMs;
+    } else if (m_telemetryRecorder.isOpen()) {
+        // Recordings keep the configured rate, visible or not
+        interval = m_config->monitorIntervalMs();
+    } else if (m_config->minimizeToTray()) {
+        // Only the tray tooltip is left to feed
+        interval = TRAY_MONITOR_INTERVAL_MS;
+    }
+
+    // Effective frequencies only feed the table, at their own fixed rate
+    if (m_config->measureEffectiveFrequency() && isWindowVisible()) {
+        if (!m_effectiveFreqTimer.isActive()) {
+            m_effectiveFreqTimer.start();
+        }
+    } else {
+        m_effectiveFreqTimer.stop();
+    }
+
+    if (interval == 0) {
+        m_frequencySampler->stop();
+        return;
+    }
+
+    if (m_frequencySampler->interval() != interval) {
+        m_frequencySampler->setInterval(interval);
+    }
+    m_frequencySampler->start();
 }
 
 void Application::showMainWindow()
@@ -120,6 +231,9 @@ void Application::setCurrentCpu(int cpu)
     m_currentCpu = cpu;
     m_allCpusSelected = false;
 
+    // Make sure the state properties below reflect the system right now
+    m_sysfsReader->snapshot(cpu);
+
     updateGovernorModel();
     updateEnergyPrefModel();
 
@@ -138,44 +252,57 @@ void Application::setAllCpusSelected(bool all)
     emit allCpusSelectedChanged();
 }
 
+const CpuSnapshot *Application::currentSnapshot() const
+{
+    return m_sysfsReader->lastSnapshot(m_currentCpu);
+}
+
 qint64 Application::currentMinFreq() const
 {
-    return m_sysfsReader->minFrequency(m_currentCpu);
+    const CpuSnapshot *snap = currentSnapshot();
+    return snap ? snap->scalingMin : 0;
 }
 
 qint64 Application::currentMaxFreq() const
 {
-    return m_sysfsReader->maxFrequency(m_currentCpu);
+    const CpuSnapshot *snap = currentSnapshot();
+    return snap ? snap->scalingMax : 0;
 }
 
 qint64 Application::hardwareMinFreq() const
 {
-    return m_sysfsReader->minFrequencyHardware(m_currentCpu);
+    const CpuSnapshot *snap = currentSnapshot();
+    return snap ? snap->hwMin : 0;
 }
 
 qint64 Application::hardwareMaxFreq() const
 {
-    return m_sysfsReader->maxFrequencyHardware(m_currentCpu);
+    const CpuSnapshot *snap = currentSnapshot();
+    return snap ? snap->hwMax : 0;
 }
 
 QString Application::currentGovernor() const
 {
-    return m_sysfsReader->currentGovernor(m_currentCpu);
+    const CpuSnapshot *snap = currentSnapshot();
+    return snap ? m_sysfsReader->internedString(snap->governorId) : QString();
 }
 
 QString Application::currentEnergyPref() const
 {
-    return m_sysfsReader->currentEnergyPref(m_currentCpu);
+    const CpuSnapshot *snap = currentSnapshot();
+    return snap ? m_sysfsReader->internedString(snap->energyPrefId) : QString();
 }
 
 bool Application::energyPrefAvailable() const
 {
-    return m_sysfsReader->isEnergyPrefAvailable(m_currentCpu);
+    const CpuSnapshot *snap = currentSnapshot();
+    return snap && snap->energyPrefAvailable;
 }
 
 bool Application::cpuOnline() const
 {
-    return m_sysfsReader->isOnline(m_currentCpu);
+    const CpuSnapshot *snap = currentSnapshot();
+    return snap && snap->online();
 }
 
 void Application::setMinFrequency(qint64 freqKhz)
@@ -235,21 +362,50 @@ void Application::applyChanges()
 
     setStatusMessage(tr("Applying changes..."));
 
-    QList<int> cpusToApply;
+    // Pending values are applied on top of a fresh view of the system
+    QList<CpuSnapshot> cpusToApply;
     if (m_allCpusSelected) {
-        cpusToApply = m_sysfsReader->availableCpus();
+        cpusToApply = m_sysfsReader->snapshotAll();
     } else {
-        cpusToApply.append(m_currentCpu);
+        cpusToApply.append(m_sysfsReader->snapshot(m_currentCpu));
     }
 
     // Begin batch mode - queue all operations
     m_dbusHelper->beginBatch();
 
-    for (int cpu : cpusToApply) {
+    // CPUs of one cpufreq policy share its attributes: one write per policy
+    // applies the change to all of them
+    QSet<int> writtenPolicies;
+
+    for (const CpuSnapshot &snap : std::as_const(cpusToApply)) {
+        const int cpu = snap.cpu;
+
+        // The batch brings every CPU it touches online, so leave offline CPUs
+        // alone unless this change is what onlines them
+        if (!snap.online() && !(m_hasPendingOnline && m_pendingOnline)) {
+            continue;
+        }
+
+        // Apply online/offline state (CPU 0 cannot be offlined)
+        if (m_hasPendingOnline && cpu != 0) {
+            if (m_pendingOnline) {
+                m_dbusHelper->setCpuOnlineAsync(cpu);
+            } else {
+                m_dbusHelper->setCpuOfflineAsync(cpu);
+                continue;
+            }
+        }
+
+        const int policy = snap.policy >= 0 ? snap.policy : cpu;
+        if (writtenPolicies.contains(policy)) {
+            continue;
+        }
+        writtenPolicies.insert(policy);
+
         // Apply frequency settings (min and max together)
         if (m_hasPendingMinFreq || m_hasPendingMaxFreq) {
-            qint64 fmin = m_hasPendingMinFreq ? m_pendingMinFreq : m_sysfsReader->minFrequency(cpu);
-            qint64 fmax = m_hasPendingMaxFreq ? m_pendingMaxFreq : m_sysfsReader->maxFrequency(cpu);
+            qint64 fmin = m_hasPendingMinFreq ? m_pendingMinFreq : snap.scalingMin;
+            qint64 fmax = m_hasPendingMaxFreq ? m_pendingMaxFreq : snap.scalingMax;
 
             qDebug() << "Applying frequency to CPU" << cpu << ": min=" << fmin << "max=" << fmax
                      << "(pending min:" << m_hasPendingMinFreq << "pending max:" << m_hasPendingMaxFreq << ")";
@@ -264,19 +420,10 @@ void Application::applyChanges()
 
         // Apply energy preference
         if (m_hasPendingEnergyPref && !m_pendingEnergyPref.isEmpty()) {
-            if (m_sysfsReader->isEnergyPrefAvailable(cpu)) {
+            if (snap.energyPrefAvailable) {
                 m_dbusHelper->updateCpuEnergyPrefsAsync(cpu, m_pendingEnergyPref);
             }
         }
-
-        // Apply online/offline state (CPU 0 cannot be offlined)
-        if (m_hasPendingOnline && cpu != 0) {
-            if (m_pendingOnline) {
-                m_dbusHelper->setCpuOnlineAsync(cpu);
-            } else {
-                m_dbusHelper->setCpuOfflineAsync(cpu);
-            }
-        }
     }
 
     // Clear pending changes - results will be handled in onBatchCompleted
@@ -302,13 +449,20 @@ void Application::clearPendingChanges()
     m_hasPendingOnline = false;
 }
 
-void Application::onBatchCompleted(bool allSucceeded, const QStringList &errors)
+void Application::onBatchCompleted(bool allSucceeded, const QStringList &errors, int writesPerformed)
 {
-    // Refresh CPU info to show current state
-    refreshCpuInfo();
+    // CpuStateChanged has already refreshed the CPUs that changed, either
+    // from the helper (before its reply) or from DbusHelper for CPUs the
+    // helper did not report; pending values were cleared, so views fall
+    // back to the system state
+    emit currentCpuStateChanged();
 
     if (allSucceeded) {
-        setStatusMessage(tr("Changes applied successfully"));
+        if (writesPerformed > 0) {
+            setStatusMessage(tr("Changes applied successfully"));
+        } else {
+            setStatusMessage(tr("Settings already up to date"));
+        }
         emit applySuccess();
     } else {
         setStatusMessage(tr("Some changes failed to apply"));
@@ -347,58 +501,191 @@ void Application::applyProfile(const QString &profileName)
 
     setStatusMessage(tr("Applying profile: %1").arg(profileName));
 
-    // Begin batch mode - queue all operations
-    m_dbusHelper->beginBatch();
+    // Completion will trigger onBatchCompleted
+    m_dbusHelper->applyPlanAsync(ProfileManager::compilePlan(*profile, m_sysfsReader.get()));
+}
 
-    // Apply settings for each CPU in the profile
-    for (auto it = profile->settings.constBegin(); it != profile->settings.constEnd(); ++it) {
-        int cpu = it.key();
-        const CpuProfileEntry &entry = it.value();
+void Application::refreshCpuInfo()
+{
+    // CPUs may have been hot(un)plugged since the descriptors were opened
+    m_sysfsReader->invalidateDescriptors();
+    m_cpuModel->refreshAll();
+    updateGovernorModel();
+    updateEnergyPrefModel();
+    emit currentCpuStateChanged();
+    setStatusMessage(tr("CPU info refreshed"));
+}
 
-        // Check if this CPU exists
-        if (!m_sysfsReader->availableCpus().contains(cpu)) {
-            qWarning() << "Profile references non-existent CPU" << cpu;
-            continue;
-        }
+void Application::onCpuHotplugged(int cpu, HotplugMonitor::Action action)
+{
+    if (action == HotplugMonitor::CpuAdded || action == HotplugMonitor::CpuRemoved) {
+        // The set of CPUs changed: rows have to be rebuilt
+        m_sysfsReader->invalidateDescriptors();
+        m_cpuModel->reload();
+    } else {
+        m_sysfsReader->invalidateDescriptors(cpu);
+        m_sysfsReader->refreshCpuMasks();
+        m_cpuModel->refreshCpu(cpu);
+    }
 
-        // Apply online/offline state first (CPU 0 cannot be offlined)
-        if (cpu != 0) {
-            if (entry.online) {
-                m_dbusHelper->setCpuOnlineAsync(cpu);
-            } else {
-                m_dbusHelper->setCpuOfflineAsync(cpu);
-                // If we're setting CPU offline, skip other settings for this CPU
-                continue;
-            }
-        }
+    if (cpu == m_currentCpu) {
+        updateGovernorModel();
+        updateEnergyPrefModel();
+        emit currentCpuStateChanged();
+    }
+}
 
-        // Apply frequency settings
-        if (entry.freqMin > 0 && entry.freqMax > 0) {
-            m_dbusHelper->updateCpuSettingsAsync(cpu, static_cast<int>(entry.freqMin), static_cast<int>(entry.freqMax));
+void Application::onHotplugEventsLost()
+{
+    // Any CPU may have come or gone unnoticed: start over from sysfs
+    m_sysfsReader->invalidateDescriptors();
+    m_sysfsReader->refreshCpuMasks();
+    m_cpuModel->reload();
+    updateGovernorModel();
+    updateEnergyPrefModel();
+    emit currentCpuStateChanged();
+}
+
+void Application::onCpuStateChanged(const QList<int> &cpus, uint fields)
+{
+    if (fields & CpuField::Online) {
+        for (int cpu : cpus) {
+            m_sysfsReader->invalidateDescriptors(cpu);
         }
+        m_sysfsReader->refreshCpuMasks();
+    }
 
-        // Apply governor
-        if (!entry.governor.isEmpty()) {
-            m_dbusHelper->updateCpuGovernorAsync(cpu, entry.governor);
+    bool currentChanged = false;
+    for (int cpu : cpus) {
+        m_cpuModel->refreshCpu(cpu);
+        currentChanged |= cpu == m_currentCpu;
+    }
+
+    if (currentChanged) {
+        updateGovernorModel();
+        updateEnergyPrefModel();
+        emit currentCpuStateChanged();
+    }
+}
+
+void Application::onFrequencySample()
+{
+    if (!m_frequencySampler->latest(m_frequencySample, m_busySample, m_iowaitSample)) {
+        return;
+    }
+
+    // Faster ticks than the history's cadence are dropped there
+    const bool historyChanged = m_frequencyHistory.append(m_frequencySample, m_historyClock.elapsed());
+    if (m_telemetryRecorder.isOpen()) {
+        recordSample(QDateTime::currentMSecsSinceEpoch());
+    }
+
+    if (!isWindowVisible()) {
+        updateTrayStatus();
+        return;
+    }
+
+    if (historyChanged) {
+        m_frequencyHistoryModel->refresh();
+    }
+
+    // Back off while nothing moves, return to the configured rate on change
+    const int baseInterval = m_config->monitorIntervalMs();
+    // Both setters run every tick, each emits its own dataChanged
+    const bool freqsChanged = m_cpuModel->setCurrentFrequencies(m_frequencySample);
+    const bool loadChanged = m_cpuModel->setLoad(m_busySample, m_iowaitSample);
+    if (freqsChanged || loadChanged) {
+        m_stableSamples = 0;
+        if (m_monitorIntervalMs != baseInterval) {
+            m_monitorIntervalMs = baseInterval;
+            updateMonitoring();
+        }
+    } else if (!m_telemetryRecorder.isOpen() && ++m_stableSamples >= STABLE_SAMPLES_BEFORE_BACKOFF) {
+        m_stableSamples = 0;
+        const int slowest = qMin(baseInterval * MAX_BACKOFF_FACTOR, AppConfig::MAX_MONITOR_INTERVAL_MS);
+        if (m_monitorIntervalMs < slowest) {
+            m_monitorIntervalMs = qMin(m_monitorIntervalMs * 2, slowest);
+            updateMonitoring();
         }
+    }
+}
 
-        // Apply energy preference
-        if (!entry.energyPref.isEmpty() && m_sysfsReader->isEnergyPrefAvailable(cpu)) {
-            m_dbusHelper->updateCpuEnergyPrefsAsync(cpu, entry.energyPref);
+void Application::restartRecording()
+{
+    // The reader maps the file the recorder may be about to recreate
+    if (m_telemetryReader) {
+        m_telemetryReader->close();
+    }
+    m_telemetryRecorder.close();
+
+    if (m_config->recordTelemetry()) {
+        if (!m_telemetryRecorder.open(TelemetryFile::defaultPath(), m_cpuModel->rowCpus(),
+                                      m_config->monitorIntervalMs())) {
+            setStatusMessage(tr("Cannot record telemetry to %1").arg(TelemetryFile::defaultPath()));
         }
+        m_monitorIntervalMs = m_config->monitorIntervalMs();
     }
+}
 
-    // End batch and start processing - completion will trigger onBatchCompleted
-    m_dbusHelper->endBatch();
+void Application::recordSample(qint64 timestampMs)
+{
+    const QList<int> cpus = m_frequencyHistory.cpus();
+    m_recordGovernors.resize(cpus.size());
+    m_recordOnline.resize(cpus.size());
+
+    for (qsizetype row = 0; row < cpus.size(); ++row) {
+        const CpuSnapshot *snap = m_sysfsReader->lastSnapshot(cpus.at(row));
+        m_recordGovernors[row] = snap
+                ? m_telemetryRecorder.governorIndex(m_sysfsReader->internedString(snap->governorId))
+                : TelemetryFile::NO_GOVERNOR;
+        // The sample itself knows best: offline CPUs have no frequency
+        m_recordOnline[row] = m_frequencySample.value(row) > 0;
+    }
+
+    m_telemetryRecorder.append(timestampMs, m_frequencySample, m_busySample, m_recordGovernors, m_recordOnline);
 }
 
-void Application::refreshCpuInfo()
+QVariantList Application::recordedHistory(int cpu, qint64 fromMs, qint64 toMs, int maxSamples)
 {
-    m_cpuModel->refresh();
-    updateGovernorModel();
-    updateEnergyPrefModel();
-    emit currentCpuStateChanged();
-    setStatusMessage(tr("CPU info refreshed"));
+    if (!m_telemetryReader) {
+        m_telemetryReader = std::make_unique<TelemetryReader>();
+    }
+
+    QVariantList result;
+    const QList<TelemetryReader::Sample> samples = m_telemetryReader->range(cpu, fromMs, toMs, maxSamples);
+    result.reserve(samples.size());
+    for (const TelemetryReader::Sample &sample : samples) {
+        result.append(QVariantMap{
+            {QStringLiteral("time"), sample.timestampMs},
+            {QStringLiteral("freq"), sample.freqKhz / 1000.0},
+            {QStringLiteral("load"), sample.busyPermille / 10.0},
+            {QStringLiteral("governor"), sample.governor},
+            {QStringLiteral("online"), sample.online}
+        });
+    }
+    return result;
+}
+
+void Application::updateTrayStatus()
+{
+    qint64 sum = 0;
+    int online = 0;
+    int highest = 0;
+    for (int khz : std::as_const(m_frequencySample)) {
+        if (khz > 0) {
+            sum += khz;
+            highest = qMax(highest, khz);
+            ++online;
+        }
+    }
+
+    if (online == 0) {
+        return;
+    }
+
+    m_trayIcon->setStatusText(tr("Average %1 MHz, highest %2 MHz")
+                                  .arg(sum / online / 1000)
+                                  .arg(highest / 1000));
 }
 
 void Application::onDbusHelperReady(bool ready)
@@ -424,7 +711,7 @@ void Application::updateGovernorModel()
 
 void Application::updateEnergyPrefModel()
 {
-    if (m_sysfsReader->isEnergyPrefAvailable(m_currentCpu)) {
+    if (energyPrefAvailable()) {
         const QStringList prefs = m_sysfsReader->availableEnergyPrefs(m_currentCpu);
         m_energyPrefModel->setPreferences(prefs);
     } else {
@@ -4,6 +4,7 @@
 #ifndef APPLICATION_H
 #define APPLICATION_H
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QQmlApplicationEngine>
 #include <QTimer>
@@ -12,14 +13,21 @@
 // Include full headers for types exposed via Q_PROPERTY
 #include "core/sysfsreader.h"
 #include "core/dbushelper.h"
+#include "core/frequencysampler.h"
+#include "core/hotplugmonitor.h"
+#include "core/telemetryhistory.h"
+#include "core/telemetryreader.h"
+#include "core/telemetryrecorder.h"
 #include "config/appconfig.h"
 #include "config/profilemanager.h"
 #include "models/cpulistmodel.h"
 #include "models/profilemodel.h"
 #include "models/governormodel.h"
 #include "models/energyprefmodel.h"
+#include "models/sparklinemodel.h"
 
 class TrayIcon;
+class SysfsBackend;
 
 /**
  * @brief Main application controller
@@ -36,6 +44,7 @@ class Application : public QObject
     Q_PROPERTY(ProfileModel* profileModel READ profileModel CONSTANT)
     Q_PROPERTY(GovernorModel* governorModel READ governorModel CONSTANT)
     Q_PROPERTY(EnergyPrefModel* energyPrefModel READ energyPrefModel CONSTANT)
+    Q_PROPERTY(SparklineModel* frequencyHistory READ frequencyHistory CONSTANT)
 
     // Expose managers
     Q_PROPERTY(AppConfig* config READ config CONSTANT)
@@ -62,7 +71,8 @@ class Application : public QObject
     Q_PROPERTY(QString statusMessage READ statusMessage NOTIFY statusMessageChanged)
 
 public:
-    explicit Application(QObject *parent = nullptr);
+    // @p backend is the sysfs storage used for all reads; it must outlive the application
+    explicit Application(SysfsBackend *backend, QObject *parent = nullptr);
     ~Application() override;
 
     // Initialize the QML engine
@@ -76,6 +86,7 @@ public:
     ProfileModel *profileModel() const { return m_profileModel.get(); }
     GovernorModel *governorModel() const { return m_governorModel.get(); }
     EnergyPrefModel *energyPrefModel() const { return m_energyPrefModel.get(); }
+    SparklineModel *frequencyHistory() const { return m_frequencyHistoryModel.get(); }
 
     // Manager accessors
     AppConfig *config() const { return m_config.get(); }
@@ -115,6 +126,11 @@ public:
     Q_INVOKABLE void applyProfile(const QString &profileName);
     Q_INVOKABLE void refreshCpuInfo();
 
+    // Samples of @p cpu recorded to the telemetry file between the two times
+    // (ms since the epoch), as maps with time, freq (MHz), load (%), governor
+    // and online. Strided down to @p maxSamples when > 0.
+    Q_INVOKABLE QVariantList recordedHistory(int cpu, qint64 fromMs, qint64 toMs, int maxSamples = 0);
+
 signals:
     void currentCpuChanged();
     void allCpusSelectedChanged();
@@ -128,26 +144,39 @@ signals:
 private slots:
     void onDbusHelperReady(bool ready);
     void onDbusError(const QString &error);
-    void onBatchCompleted(bool allSucceeded, const QStringList &errors);
+    void onBatchCompleted(bool allSucceeded, const QStringList &errors, int writesPerformed);
+    void onCpuHotplugged(int cpu, HotplugMonitor::Action action);
+    void onHotplugEventsLost();
+    void onCpuStateChanged(const QList<int> &cpus, uint fields);
+    void onFrequencySample();
+    void updateMonitoring();
 
 private:
     void initializeBackend();
+    const CpuSnapshot *currentSnapshot() const;
     void updateGovernorModel();
     void updateEnergyPrefModel();
     void setStatusMessage(const QString &msg);
     void setUnsavedChanges(bool changed);
+    bool isWindowVisible() const;
+    void updateTrayStatus();
+    void restartRecording();
+    void recordSample(qint64 timestampMs);
 
     // Backend objects
+    SysfsBackend *m_backend;
     std::unique_ptr<SysfsReader> m_sysfsReader;
     std::unique_ptr<DbusHelper> m_dbusHelper;
     std::unique_ptr<AppConfig> m_config;
     std::unique_ptr<ProfileManager> m_profileManager;
+    std::unique_ptr<HotplugMonitor> m_hotplugMonitor;
 
     // Models
     std::unique_ptr<CpuListModel> m_cpuModel;
     std::unique_ptr<ProfileModel> m_profileModel;
     std::unique_ptr<GovernorModel> m_governorModel;
     std::unique_ptr<EnergyPrefModel> m_energyPrefModel;
+    std::unique_ptr<SparklineModel> m_frequencyHistoryModel;
 
     // Tray
     std::unique_ptr<TrayIcon> m_trayIcon;
@@ -175,9 +204,38 @@ private:
     // Helper methods
     void clearPendingChanges();
 
-    // Frequency monitoring timer
-    QTimer *m_freqMonitorTimer{nullptr};
-    static constexpr int FREQ_MONITOR_INTERVAL_MS = 500;
+    // Live frequency monitoring (sampled on its own thread)
+    // Runs at m_monitorIntervalMs while the window is visible (the configured
+    // rate, doubled after each run of stable samples up to MAX_BACKOFF_FACTOR
+    // times), at TRAY_MONITOR_INTERVAL_MS in the tray and not at all otherwise.
+    std::unique_ptr<FrequencySampler> m_frequencySampler;
+    QList<int> m_frequencySample;
+    QList<int> m_busySample;
+    QList<int> m_iowaitSample;
+    int m_monitorIntervalMs{0};
+    int m_stableSamples{0};
+    static constexpr int TRAY_MONITOR_INTERVAL_MS = 10000;
+    static constexpr int STABLE_SAMPLES_BEFORE_BACKOFF = 4;
+    static constexpr int MAX_BACKOFF_FACTOR = 8;
+
+    // Effective frequency requests (AppConfig::measureEffectiveFrequency),
+    // independent of the monitor rate and only while the window is visible
+    QTimer m_effectiveFreqTimer;
+    static constexpr int EFFECTIVE_FREQ_INTERVAL_MS = 2000;
+    static constexpr uint EFFECTIVE_FREQ_WINDOW_MS = 1000;
+
+    // Monitor samples (kHz per model row) at most every SAMPLE_INTERVAL_MS,
+    // DEFAULT_CAPACITY samples deep. Timestamped by a monotonic clock, so the
+    // time buckets survive wall clock steps.
+    TelemetryHistory m_frequencyHistory;
+    QElapsedTimer m_historyClock;
+
+    // Recorder mode (AppConfig::recordTelemetry): every sample also goes to
+    // the telemetry file. The reader is created on the first query.
+    TelemetryRecorder m_telemetryRecorder;
+    std::unique_ptr<TelemetryReader> m_telemetryReader;
+    QList<quint8> m_recordGovernors;
+    QList<bool> m_recordOnline;
 
     // QML engine reference for window management
     QQmlApplicationEngine *m_engine{nullptr};
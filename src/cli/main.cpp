@@ -0,0 +1,421 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QLoggingCategory>
+#include <QRegularExpression>
+#include <QTextStream>
+
+#include <memory>
+
+#include "config/appconfig.h"
+#include "config/profilemanager.h"
+#include "core/dbushelper.h"
+#include "core/sysfsbackend.h"
+#include "core/sysfsreader.h"
+
+/*
+ * Headless front-end for scripts and units. Queries read sysfs directly;
+ * only set and apply-profile start a D-Bus connection to the helper, so the
+ * read-only commands never pay for it. Frequencies are in MHz, like in
+ * profile files.
+ */
+
+namespace {
+
+enum ExitCode {
+    ExitOk = 0,
+    ExitFailed = 1,
+    ExitUsage = 2
+};
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+QString mhz(int khz)
+{
+    return khz > 0 ? QString::number(khz / 1000) : QStringLiteral("-");
+}
+
+QString orDash(const QString &value)
+{
+    return value.isEmpty() ? QStringLiteral("-") : value;
+}
+
+// "all" or a sysfs style list such as "0-3,8"; only CPUs that exist
+bool parseCpus(const QString &spec, SysfsReader &sysfs, QList<int> &cpus)
+{
+    // Callers look CPUs up with lastSnapshot(), so build the layout first
+    sysfs.snapshots();
+    if (spec == QLatin1String("all")) {
+        cpus = sysfs.availableCpus();
+        return true;
+    }
+
+    static const QRegularExpression cpuList(QStringLiteral("^\\d+(-\\d+)?(,\\d+(-\\d+)?)*$"));
+    if (!cpuList.match(spec).hasMatch()) {
+        err() << "Invalid CPU list: " << spec << Qt::endl;
+        return false;
+    }
+
+    cpus = SysfsReader::parseCpuList(spec);
+    for (int cpu : std::as_const(cpus)) {
+        if (!sysfs.lastSnapshot(cpu)) {
+            err() << "No such CPU: " << cpu << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// A frequency option in MHz; unset leaves @p mhz at 0
+bool parseMhz(const QCommandLineParser &parser, const QCommandLineOption &option, int &mhz)
+{
+    mhz = 0;
+    if (!parser.isSet(option)) {
+        return true;
+    }
+
+    bool ok = false;
+    const QString value = parser.value(option);
+    mhz = value.toInt(&ok);
+    if (!ok || mhz <= 0) {
+        err() << "Invalid --" << option.names().constFirst() << ": " << value << Qt::endl;
+        return false;
+    }
+    return true;
+}
+
+// Sends @p plan through the helper and waits for the batch to finish
+int applyPlan(const QList<PlanEntry> &plan)
+{
+    if (plan.isEmpty()) {
+        err() << "Nothing to apply" << Qt::endl;
+        return ExitOk;
+    }
+
+    DbusHelper helper;
+    if (!helper.isConnected()) {
+        err() << "cpupower-gui-helper is not available" << Qt::endl;
+        return ExitFailed;
+    }
+
+    QEventLoop loop;
+    bool done = false;
+    int exitCode = ExitFailed;
+    QObject::connect(&helper, &DbusHelper::batchCompleted,
+                     [&](bool allSucceeded, const QStringList &errors, int writesPerformed) {
+        for (const QString &error : errors) {
+            err() << error << Qt::endl;
+        }
+        if (allSucceeded) {
+            out() << "Applied to " << plan.size() << " CPUs (" << writesPerformed << " writes)" << Qt::endl;
+        }
+        exitCode = allSucceeded ? ExitOk : ExitFailed;
+        done = true;
+        loop.quit();
+    });
+
+    helper.applyPlanAsync(plan);
+    if (!done) {
+        loop.exec();
+    }
+    return exitCode;
+}
+
+// ============================================================================
+// Commands
+// ============================================================================
+
+int listCpus(SysfsReader &sysfs)
+{
+    out() << QStringLiteral("%1 %2 %3 %4 %5 %6 %7")
+                 .arg(QStringLiteral("CPU"), -4)
+                 .arg(QStringLiteral("ONLINE"), -6)
+                 .arg(QStringLiteral("GOVERNOR"), -12)
+                 .arg(QStringLiteral("CUR"), 5)
+                 .arg(QStringLiteral("MIN"), 5)
+                 .arg(QStringLiteral("MAX"), 5)
+                 .arg(QStringLiteral("EPP"))
+          << Qt::endl;
+
+    for (const CpuSnapshot &snap : sysfs.snapshotAll()) {
+        const bool online = snap.online();
+        out() << QStringLiteral("%1 %2 %3 %4 %5 %6 %7")
+                     .arg(snap.cpu, -4)
+                     .arg(online ? QStringLiteral("yes") : QStringLiteral("no"), -6)
+                     .arg(orDash(online ? sysfs.internedString(snap.governorId) : QString()), -12)
+                     .arg(mhz(online ? snap.curFreq : 0), 5)
+                     .arg(mhz(online ? snap.scalingMin : 0), 5)
+                     .arg(mhz(online ? snap.scalingMax : 0), 5)
+                     .arg(orDash(online && snap.energyPrefAvailable ? sysfs.internedString(snap.energyPrefId)
+                                                                    : QString()))
+              << Qt::endl;
+    }
+    return ExitOk;
+}
+
+int listProfiles(SysfsReader &sysfs)
+{
+    const AppConfig config;
+    const ProfileManager profiles(&sysfs);
+
+    for (const QString &name : profiles.profileNames()) {
+        QString origin = QStringLiteral("user");
+        if (profiles.isBuiltinProfile(name)) {
+            origin = QStringLiteral("builtin");
+        } else if (profiles.isSystemProfile(name)) {
+            origin = QStringLiteral("system");
+        }
+        const QChar marker = name == config.defaultProfile() ? QLatin1Char('*') : QLatin1Char(' ');
+        out() << marker << ' ' << QStringLiteral("%1").arg(name, -24) << ' ' << origin << Qt::endl;
+    }
+    return ExitOk;
+}
+
+int get(SysfsReader &sysfs, const QStringList &args)
+{
+    if (args.isEmpty() || args.size() > 2) {
+        err() << "Usage: get <cpu> [field]" << Qt::endl;
+        return ExitUsage;
+    }
+
+    bool ok = false;
+    const int cpu = args.at(0).toInt(&ok);
+    const CpuSnapshot snap = ok ? sysfs.snapshot(cpu) : CpuSnapshot();
+    if (snap.state == CpuSnapshot::NotPresent) {
+        err() << "No such CPU: " << args.at(0) << Qt::endl;
+        return ExitFailed;
+    }
+
+    const bool online = snap.online();
+    const QList<QPair<QString, QString>> fields = {
+        {QStringLiteral("online"), online ? QStringLiteral("yes") : QStringLiteral("no")},
+        {QStringLiteral("policy"), snap.policy >= 0 ? QString::number(snap.policy) : QStringLiteral("-")},
+        {QStringLiteral("governor"), orDash(online ? sysfs.internedString(snap.governorId) : QString())},
+        {QStringLiteral("available_governors"), orDash(sysfs.availableGovernors(cpu).join(QLatin1Char(' ')))},
+        {QStringLiteral("cur_mhz"), mhz(online ? snap.curFreq : 0)},
+        {QStringLiteral("min_mhz"), mhz(online ? snap.scalingMin : 0)},
+        {QStringLiteral("max_mhz"), mhz(online ? snap.scalingMax : 0)},
+        {QStringLiteral("hw_min_mhz"), mhz(snap.hwMin)},
+        {QStringLiteral("hw_max_mhz"), mhz(snap.hwMax)},
+        {QStringLiteral("epp"), orDash(online && snap.energyPrefAvailable ? sysfs.internedString(snap.energyPrefId)
+                                                                          : QString())},
+        {QStringLiteral("available_epps"), orDash(sysfs.availableEnergyPrefs(cpu).join(QLatin1Char(' ')))},
+    };
+
+    if (args.size() == 2) {
+        for (const auto &field : fields) {
+            if (field.first == args.at(1)) {
+                out() << field.second << Qt::endl;
+                return ExitOk;
+            }
+        }
+        err() << "Unknown field: " << args.at(1) << Qt::endl;
+        return ExitUsage;
+    }
+
+    for (const auto &field : fields) {
+        out() << field.first << ": " << field.second << Qt::endl;
+    }
+    return ExitOk;
+}
+
+struct SetOptions {
+    int minMhz = 0;
+    int maxMhz = 0;
+    QString governor;
+    QString energyPref;
+    bool setOnline = false;
+    bool setOffline = false;
+};
+
+int set(SysfsReader &sysfs, const QStringList &args, const SetOptions &options)
+{
+    if (args.size() != 1) {
+        err() << "Usage: set <cpus> [--min MHz] [--max MHz] [--governor name] [--epp name] [--online|--offline]"
+              << Qt::endl;
+        return ExitUsage;
+    }
+    if (options.setOnline && options.setOffline) {
+        err() << "--online and --offline are mutually exclusive" << Qt::endl;
+        return ExitUsage;
+    }
+    if (options.minMhz <= 0 && options.maxMhz <= 0 && options.governor.isEmpty() && options.energyPref.isEmpty()
+        && !options.setOnline && !options.setOffline) {
+        err() << "Nothing to set" << Qt::endl;
+        return ExitUsage;
+    }
+
+    QList<int> cpus;
+    if (!parseCpus(args.at(0), sysfs, cpus)) {
+        return ExitUsage;
+    }
+
+    QList<PlanEntry> plan;
+    for (int cpu : std::as_const(cpus)) {
+        const CpuSnapshot *snap = sysfs.lastSnapshot(cpu);
+        if (!snap) {
+            err() << "CPU " << cpu << " is not available, skipping" << Qt::endl;
+            continue;
+        }
+
+        // The plan brings every CPU it lists online, so leave offline CPUs
+        // alone unless they are meant to come online
+        if (!snap->online() && !options.setOnline) {
+            continue;
+        }
+
+        PlanEntry entry;
+        entry.cpu = cpu;
+        if (options.setOffline) {
+            if (!sysfs.cpuAllowedOffline(cpu)) {
+                err() << "CPU " << cpu << " cannot be taken offline, skipping" << Qt::endl;
+                continue;
+            }
+            entry.online = false;
+            plan.append(entry);
+            continue;
+        }
+
+        // Min and max are written together, the other one keeps its value
+        if (options.minMhz > 0 || options.maxMhz > 0) {
+            entry.freqMin = options.minMhz > 0 ? options.minMhz * 1000 : snap->scalingMin;
+            entry.freqMax = options.maxMhz > 0 ? options.maxMhz * 1000 : snap->scalingMax;
+        }
+        entry.governor = options.governor;
+        if (!options.energyPref.isEmpty()) {
+            if (snap->energyPrefAvailable) {
+                entry.energyPref = options.energyPref;
+            } else {
+                err() << "CPU " << cpu << " has no energy performance preference, ignoring --epp" << Qt::endl;
+            }
+        }
+        plan.append(entry);
+    }
+
+    return applyPlan(plan);
+}
+
+int applyProfile(SysfsReader &sysfs, const QStringList &args)
+{
+    if (args.size() > 1) {
+        err() << "Usage: apply-profile [name]" << Qt::endl;
+        return ExitUsage;
+    }
+
+    // Without a name, the default profile from the configuration
+    const QString name = args.isEmpty() ? AppConfig().defaultProfile() : args.at(0);
+    const ProfileManager profiles(&sysfs);
+    const Profile *profile = profiles.profile(name);
+    if (!profile) {
+        err() << "Profile not found: " << name << Qt::endl;
+        return ExitFailed;
+    }
+
+    return applyPlan(ProfileManager::compilePlan(*profile, &sysfs));
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    app.setApplicationName(QStringLiteral("cpupower-gui-cli"));
+    app.setApplicationVersion(QStringLiteral("1.0.0"));
+    app.setOrganizationDomain(QStringLiteral("github.io"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Command line front-end for cpupower-gui.\n"
+        "\n"
+        "Commands:\n"
+        "  list [cpus|profiles]      Show the state of every CPU, or the profiles (* = default)\n"
+        "  get <cpu> [field]         Show one CPU, or a single field of it\n"
+        "  set <cpus> [options]      Change CPUs (\"all\" or a list like 0-3,8) through the helper\n"
+        "  apply-profile [name]      Apply a profile, by default the configured one\n"
+        "\n"
+        "Frequencies are in MHz. Changes may need a polkit agent (e.g. pkttyagent)."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument(QStringLiteral("command"), QStringLiteral("list, get, set or apply-profile"));
+    parser.addPositionalArgument(QStringLiteral("arguments"), QStringLiteral("Arguments of the command"),
+                                 QStringLiteral("[arguments...]"));
+
+    QCommandLineOption minOption(QStringLiteral("min"), QStringLiteral("set: minimum frequency in MHz."),
+                                 QStringLiteral("MHz"));
+    QCommandLineOption maxOption(QStringLiteral("max"), QStringLiteral("set: maximum frequency in MHz."),
+                                 QStringLiteral("MHz"));
+    QCommandLineOption governorOption(QStringLiteral("governor"), QStringLiteral("set: scaling governor."),
+                                      QStringLiteral("name"));
+    QCommandLineOption eppOption(QStringLiteral("epp"), QStringLiteral("set: energy performance preference."),
+                                 QStringLiteral("name"));
+    QCommandLineOption onlineOption(QStringLiteral("online"), QStringLiteral("set: bring the CPUs online."));
+    QCommandLineOption offlineOption(QStringLiteral("offline"), QStringLiteral("set: take the CPUs offline."));
+    QCommandLineOption verboseOption(QStringLiteral("verbose"), QStringLiteral("Print debug messages."));
+    parser.addOptions({minOption, maxOption, governorOption, eppOption, onlineOption, offlineOption, verboseOption});
+    parser.process(app);
+
+    if (!parser.isSet(verboseOption)) {
+        QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false"));
+    }
+
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        parser.showHelp(ExitUsage);
+    }
+    const QString command = args.takeFirst();
+
+    // Same storage overrides as the GUI
+    const std::unique_ptr<SysfsBackend> backend = SysfsBackend::create(
+        qEnvironmentVariable("CPUPOWER_GUI_SYSFS_ROOT"),
+        qEnvironmentVariableIntValue("CPUPOWER_GUI_FAKE_CPUS"));
+    SysfsReader sysfs(backend.get());
+
+    if (command == QLatin1String("list")) {
+        const QString what = args.value(0, QStringLiteral("cpus"));
+        if (what == QLatin1String("cpus")) {
+            return listCpus(sysfs);
+        }
+        if (what == QLatin1String("profiles")) {
+            return listProfiles(sysfs);
+        }
+        err() << "Usage: list [cpus|profiles]" << Qt::endl;
+        return ExitUsage;
+    }
+
+    if (command == QLatin1String("get")) {
+        return get(sysfs, args);
+    }
+
+    if (command == QLatin1String("set")) {
+        SetOptions options;
+        if (!parseMhz(parser, minOption, options.minMhz) || !parseMhz(parser, maxOption, options.maxMhz)) {
+            return ExitUsage;
+        }
+        options.governor = parser.value(governorOption);
+        options.energyPref = parser.value(eppOption);
+        options.setOnline = parser.isSet(onlineOption);
+        options.setOffline = parser.isSet(offlineOption);
+        return set(sysfs, args, options);
+    }
+
+    if (command == QLatin1String("apply-profile")) {
+        return applyProfile(sysfs, args);
+    }
+
+    err() << "Unknown command: " << command << Qt::endl;
+    return ExitUsage;
+}
@@ -8,7 +8,13 @@
 #include <QDebug>
 
 AppConfig::AppConfig(QObject *parent)
+    : AppConfig(Scope::SystemAndUser, parent)
+{
+}
+
+AppConfig::AppConfig(Scope scope, QObject *parent)
     : QObject(parent)
+    , m_scope(scope)
 {
     reload();
 }
@@ -118,8 +124,59 @@ void AppConfig::setEnergyPrefPerCpu(bool perCpu)
     emit configChanged();
 }
 
+int AppConfig::monitorIntervalMs() const
+{
+    return m_monitorIntervalMs;
+}
+
+void AppConfig::setMonitorIntervalMs(int ms)
+{
+    ms = qBound(MIN_MONITOR_INTERVAL_MS, ms, MAX_MONITOR_INTERVAL_MS);
+    if (m_monitorIntervalMs == ms) {
+        return;
+    }
+    m_monitorIntervalMs = ms;
+    emit monitorIntervalMsChanged();
+    emit configChanged();
+}
+
+bool AppConfig::recordTelemetry() const
+{
+    return m_recordTelemetry;
+}
+
+void AppConfig::setRecordTelemetry(bool record)
+{
+    if (m_recordTelemetry == record) {
+        return;
+    }
+    m_recordTelemetry = record;
+    emit recordTelemetryChanged();
+    emit configChanged();
+}
+
+bool AppConfig::measureEffectiveFrequency() const
+{
+    return m_measureEffectiveFrequency;
+}
+
+void AppConfig::setMeasureEffectiveFrequency(bool measure)
+{
+    if (m_measureEffectiveFrequency == measure) {
+        return;
+    }
+    m_measureEffectiveFrequency = measure;
+    emit measureEffectiveFrequencyChanged();
+    emit configChanged();
+}
+
 void AppConfig::save()
 {
+    if (m_scope == Scope::SystemOnly) {
+        qWarning() << "Not saving a system-only configuration to the user directory";
+        return;
+    }
+
     const QString userDir = userConfigDir();
     QDir dir(userDir);
     if (!dir.exists()) {
@@ -140,6 +197,9 @@ void AppConfig::save()
     settings.setValue(QStringLiteral("tick_marks_enabled"), m_tickMarksEnabled);
     settings.setValue(QStringLiteral("frequency_ticks_numeric"), m_frequencyTicksNumeric);
     settings.setValue(QStringLiteral("energy_pref_per_cpu"), m_energyPrefPerCpu);
+    settings.setValue(QStringLiteral("monitor_interval_ms"), m_monitorIntervalMs);
+    settings.setValue(QStringLiteral("record_telemetry"), m_recordTelemetry);
+    settings.setValue(QStringLiteral("measure_effective_frequency"), m_measureEffectiveFrequency);
     settings.endGroup();
 
     settings.sync();
@@ -155,9 +215,15 @@ void AppConfig::reload()
     m_tickMarksEnabled = true;
     m_frequencyTicksNumeric = false;
     m_energyPrefPerCpu = false;
+    m_monitorIntervalMs = 500;
+    m_recordTelemetry = false;
+    m_measureEffectiveFrequency = false;
 
     loadSystemConfig();
-    loadUserConfig();
+    if (m_scope == Scope::SystemAndUser) {
+        loadUserConfig();
+    }
+    m_monitorIntervalMs = qBound(MIN_MONITOR_INTERVAL_MS, m_monitorIntervalMs, MAX_MONITOR_INTERVAL_MS);
 
     emit defaultProfileChanged();
     emit minimizeToTrayChanged();
@@ -166,6 +232,9 @@ void AppConfig::reload()
     emit tickMarksEnabledChanged();
     emit frequencyTicksNumericChanged();
     emit energyPrefPerCpuChanged();
+    emit monitorIntervalMsChanged();
+    emit recordTelemetryChanged();
+    emit measureEffectiveFrequencyChanged();
     emit configChanged();
 }
 
@@ -203,6 +272,9 @@ void AppConfig::loadSystemConfig()
         m_tickMarksEnabled = settings.value(QStringLiteral("tick_marks_enabled"), m_tickMarksEnabled).toBool();
         m_frequencyTicksNumeric = settings.value(QStringLiteral("frequency_ticks_numeric"), m_frequencyTicksNumeric).toBool();
         m_energyPrefPerCpu = settings.value(QStringLiteral("energy_pref_per_cpu"), m_energyPrefPerCpu).toBool();
+        m_monitorIntervalMs = settings.value(QStringLiteral("monitor_interval_ms"), m_monitorIntervalMs).toInt();
+        m_recordTelemetry = settings.value(QStringLiteral("record_telemetry"), m_recordTelemetry).toBool();
+        m_measureEffectiveFrequency = settings.value(QStringLiteral("measure_effective_frequency"), m_measureEffectiveFrequency).toBool();
         settings.endGroup();
     }
 
@@ -239,6 +311,15 @@ void AppConfig::loadSystemConfig()
             if (settings.contains(QStringLiteral("energy_pref_per_cpu"))) {
                 m_energyPrefPerCpu = settings.value(QStringLiteral("energy_pref_per_cpu")).toBool();
             }
+            if (settings.contains(QStringLiteral("monitor_interval_ms"))) {
+                m_monitorIntervalMs = settings.value(QStringLiteral("monitor_interval_ms")).toInt();
+            }
+            if (settings.contains(QStringLiteral("record_telemetry"))) {
+                m_recordTelemetry = settings.value(QStringLiteral("record_telemetry")).toBool();
+            }
+            if (settings.contains(QStringLiteral("measure_effective_frequency"))) {
+                m_measureEffectiveFrequency = settings.value(QStringLiteral("measure_effective_frequency")).toBool();
+            }
             settings.endGroup();
         }
     }
@@ -282,6 +363,15 @@ void AppConfig::loadUserConfig()
         if (settings.contains(QStringLiteral("energy_pref_per_cpu"))) {
             m_energyPrefPerCpu = settings.value(QStringLiteral("energy_pref_per_cpu")).toBool();
         }
+        if (settings.contains(QStringLiteral("monitor_interval_ms"))) {
+            m_monitorIntervalMs = settings.value(QStringLiteral("monitor_interval_ms")).toInt();
+        }
+        if (settings.contains(QStringLiteral("record_telemetry"))) {
+            m_recordTelemetry = settings.value(QStringLiteral("record_telemetry")).toBool();
+        }
+        if (settings.contains(QStringLiteral("measure_effective_frequency"))) {
+            m_measureEffectiveFrequency = settings.value(QStringLiteral("measure_effective_frequency")).toBool();
+        }
         settings.endGroup();
     }
 }
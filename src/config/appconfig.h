@@ -30,9 +30,20 @@ class AppConfig : public QObject
     Q_PROPERTY(bool tickMarksEnabled READ tickMarksEnabled WRITE setTickMarksEnabled NOTIFY tickMarksEnabledChanged)
     Q_PROPERTY(bool frequencyTicksNumeric READ frequencyTicksNumeric WRITE setFrequencyTicksNumeric NOTIFY frequencyTicksNumericChanged)
     Q_PROPERTY(bool energyPrefPerCpu READ energyPrefPerCpu WRITE setEnergyPrefPerCpu NOTIFY energyPrefPerCpuChanged)
+    Q_PROPERTY(int monitorIntervalMs READ monitorIntervalMs WRITE setMonitorIntervalMs NOTIFY monitorIntervalMsChanged)
+    Q_PROPERTY(bool recordTelemetry READ recordTelemetry WRITE setRecordTelemetry NOTIFY recordTelemetryChanged)
+    Q_PROPERTY(bool measureEffectiveFrequency READ measureEffectiveFrequency WRITE setMeasureEffectiveFrequency NOTIFY measureEffectiveFrequencyChanged)
 
 public:
+    // Which config directories are read; the helper's boot path uses
+    // SystemOnly so it never picks up root's own ~/.config
+    enum class Scope {
+        SystemAndUser,
+        SystemOnly,
+    };
+
     explicit AppConfig(QObject *parent = nullptr);
+    explicit AppConfig(Scope scope, QObject *parent = nullptr);
     ~AppConfig() override = default;
 
     // Profile settings
@@ -58,6 +69,24 @@ public:
     bool energyPrefPerCpu() const;
     void setEnergyPrefPerCpu(bool perCpu);
 
+    // Live frequency refresh while the window is visible (clamped to the limits below)
+    int monitorIntervalMs() const;
+    void setMonitorIntervalMs(int ms);
+
+    static constexpr int MIN_MONITOR_INTERVAL_MS = 100;
+    static constexpr int MAX_MONITOR_INTERVAL_MS = 10000;
+
+    // Record every monitor sample to the telemetry file (keeps the monitor
+    // running at monitorIntervalMs even while the window is hidden)
+    bool recordTelemetry() const;
+    void setRecordTelemetry(bool record);
+
+    // Ask the helper for APERF/MPERF based frequencies while the window is
+    // visible. Off by default: it starts the root helper and interrupts
+    // every CPU on each measurement.
+    bool measureEffectiveFrequency() const;
+    void setMeasureEffectiveFrequency(bool measure);
+
     // Persistence
     Q_INVOKABLE void save();
     Q_INVOKABLE void reload();
@@ -75,12 +104,16 @@ signals:
     void tickMarksEnabledChanged();
     void frequencyTicksNumericChanged();
     void energyPrefPerCpuChanged();
+    void monitorIntervalMsChanged();
+    void recordTelemetryChanged();
+    void measureEffectiveFrequencyChanged();
     void configChanged();
 
 private:
     void loadSystemConfig();
     void loadUserConfig();
 
+    Scope m_scope{Scope::SystemAndUser};
     QString m_defaultProfile{QStringLiteral("Balanced")};
     bool m_minimizeToTray{false};
     bool m_startMinimized{false};
@@ -88,6 +121,9 @@ private:
     bool m_tickMarksEnabled{true};
     bool m_frequencyTicksNumeric{false};
     bool m_energyPrefPerCpu{false};
+    int m_monitorIntervalMs{500};
+    bool m_recordTelemetry{false};
+    bool m_measureEffectiveFrequency{false};
 };
 
 #endif // APPCONFIG_H
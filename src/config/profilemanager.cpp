@@ -11,8 +11,14 @@
 #include <QDebug>
 
 ProfileManager::ProfileManager(SysfsReader *sysfs, QObject *parent)
+    : ProfileManager(sysfs, Scope::SystemAndUser, parent)
+{
+}
+
+ProfileManager::ProfileManager(SysfsReader *sysfs, Scope scope, QObject *parent)
     : QObject(parent)
     , m_sysfs(sysfs)
+    , m_scope(scope)
 {
     loadProfiles();
 }
@@ -176,6 +182,47 @@ const Profile *ProfileManager::profile(const QString &name) const
     return nullptr;
 }
 
+QList<PlanEntry> ProfileManager::compilePlan(const Profile &profile, SysfsReader *sysfs)
+{
+    QList<PlanEntry> plan;
+    plan.reserve(profile.settings.size());
+
+    // lastSnapshot() needs the layout, which a fresh reader has not built yet
+    if (sysfs) {
+        sysfs->snapshots();
+    }
+
+    for (auto it = profile.settings.constBegin(); it != profile.settings.constEnd(); ++it) {
+        const int cpu = it.key();
+        const CpuProfileEntry &entry = it.value();
+
+        // Check if this CPU exists
+        const CpuSnapshot *snap = sysfs ? sysfs->lastSnapshot(cpu) : nullptr;
+        if (!snap) {
+            qWarning() << "Profile references non-existent CPU" << cpu;
+            continue;
+        }
+
+        PlanEntry planEntry;
+        planEntry.cpu = cpu;
+        // CPU 0 cannot be offlined
+        planEntry.online = entry.online || cpu == 0;
+        if (planEntry.online) {
+            if (entry.freqMin > 0 && entry.freqMax > 0) {
+                planEntry.freqMin = static_cast<int>(entry.freqMin);
+                planEntry.freqMax = static_cast<int>(entry.freqMax);
+            }
+            planEntry.governor = entry.governor;
+            if (snap->energyPrefAvailable) {
+                planEntry.energyPref = entry.energyPref;
+            }
+        }
+        plan.append(planEntry);
+    }
+
+    return plan;
+}
+
 QString ProfileManager::systemProfileDir()
 {
     return QStringLiteral("/etc/cpupower_gui.d");
@@ -189,6 +236,11 @@ QString ProfileManager::userProfileDir()
 
 void ProfileManager::loadProfiles()
 {
+    // Profile parsing falls back to the hardware limits of the last snapshot
+    if (m_sysfs) {
+        m_sysfs->snapshots();
+    }
+
     // Generate default profiles first
     generateDefaultProfiles();
 
@@ -196,7 +248,9 @@ void ProfileManager::loadProfiles()
     loadProfilesFromDir(systemProfileDir(), true);
 
     // Load user profiles (can override system)
-    loadProfilesFromDir(userProfileDir(), false);
+    if (m_scope == Scope::SystemAndUser) {
+        loadProfilesFromDir(userProfileDir(), false);
+    }
 }
 
 void ProfileManager::loadProfilesFromDir(const QString &dirPath, bool isSystem)
@@ -227,7 +281,8 @@ void ProfileManager::generateDefaultProfiles()
         return;
     }
 
-    const QList<int> cpus = m_sysfs->availableCpus();
+    // Hardware limits come from one snapshot sweep instead of per-CPU reads
+    const QList<CpuSnapshot> &snapshots = m_sysfs->snapshots();
 
     // Generate "Balanced" profile
     QString balancedGov;
@@ -243,14 +298,14 @@ void ProfileManager::generateDefaultProfiles()
         Profile balanced;
         balanced.name = QStringLiteral("Balanced");
         balanced.isBuiltin = true;
-        for (int cpu : cpus) {
+        for (const CpuSnapshot &snap : snapshots) {
             CpuProfileEntry entry;
-            entry.cpu = cpu;
-            entry.freqMin = m_sysfs->minFrequencyHardware(cpu);
-            entry.freqMax = m_sysfs->maxFrequencyHardware(cpu);
+            entry.cpu = snap.cpu;
+            entry.freqMin = snap.hwMin;
+            entry.freqMax = snap.hwMax;
             entry.governor = balancedGov;
             entry.online = true;
-            balanced.settings[cpu] = entry;
+            balanced.settings[snap.cpu] = entry;
         }
         m_profiles[balanced.name] = balanced;
     }
@@ -272,14 +327,14 @@ void ProfileManager::generateDefaultProfiles()
         Profile profile;
         profile.name = name;
         profile.isBuiltin = true;
-        for (int cpu : cpus) {
+        for (const CpuSnapshot &snap : snapshots) {
             CpuProfileEntry entry;
-            entry.cpu = cpu;
-            entry.freqMin = m_sysfs->minFrequencyHardware(cpu);
-            entry.freqMax = m_sysfs->maxFrequencyHardware(cpu);
+            entry.cpu = snap.cpu;
+            entry.freqMin = snap.hwMin;
+            entry.freqMax = snap.hwMax;
             entry.governor = gov;
             entry.online = true;
-            profile.settings[cpu] = entry;
+            profile.settings[snap.cpu] = entry;
         }
         m_profiles[name] = profile;
     }
@@ -400,9 +455,10 @@ Profile ProfileManager::parseProfileFile(const QString &filePath, bool isSystem)
             entry.cpu = cpu;
 
             // Use hardware limits if not specified
-            if (m_sysfs) {
-                entry.freqMin = (fmin > 0) ? fmin : m_sysfs->minFrequencyHardware(cpu);
-                entry.freqMax = (fmax > 0) ? fmax : m_sysfs->maxFrequencyHardware(cpu);
+            const CpuSnapshot *snap = m_sysfs ? m_sysfs->lastSnapshot(cpu) : nullptr;
+            if (snap) {
+                entry.freqMin = (fmin > 0) ? fmin : snap->hwMin;
+                entry.freqMax = (fmax > 0) ? fmax : snap->hwMax;
             } else {
                 entry.freqMin = fmin;
                 entry.freqMax = fmax;
@@ -11,6 +11,8 @@
 #include <QVariantMap>
 #include <QDir>
 
+#include "core/helperprotocol.h"
+
 class SysfsReader;
 
 /**
@@ -65,7 +67,15 @@ class ProfileManager : public QObject
     Q_PROPERTY(int profileCount READ profileCount NOTIFY profilesChanged)
 
 public:
+    // Which profile directories are read; the helper's boot path uses
+    // SystemOnly so it never picks up root's own ~/.config
+    enum class Scope {
+        SystemAndUser,
+        SystemOnly,
+    };
+
     explicit ProfileManager(SysfsReader *sysfs, QObject *parent = nullptr);
+    ProfileManager(SysfsReader *sysfs, Scope scope, QObject *parent = nullptr);
     ~ProfileManager() override = default;
 
     // Profile list
@@ -87,6 +97,10 @@ public:
     // Get profile object (for internal use)
     const Profile *profile(const QString &name) const;
 
+    // One plan entry per existing CPU of @p profile, for apply_plan. CPU 0
+    // stays online and energy preferences are dropped where unsupported.
+    static QList<PlanEntry> compilePlan(const Profile &profile, SysfsReader *sysfs);
+
     // Static paths
     static QString systemProfileDir();
     static QString userProfileDir();
@@ -105,6 +119,7 @@ private:
     bool writeProfileFile(const Profile &profile) const;
 
     SysfsReader *m_sysfs;
+    Scope m_scope;
     QMap<QString, Profile> m_profiles;
 };
 
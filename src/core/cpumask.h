@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef CPUMASK_H
+#define CPUMASK_H
+
+#include <QByteArray>
+#include <QList>
+#include <QtAlgorithms>
+#include <QtGlobal>
+
+/**
+ * @brief Bitset of CPU numbers
+ *
+ * Parsed from sysfs cpulist files such as /sys/devices/system/cpu/online
+ * ("0-3,5,7-9") and tested in O(1). Header-only so the helper service can
+ * share it with the GUI. CPU numbers are limited to MAX_CPUS (the kernel's
+ * largest NR_CPUS), so a bogus list or D-Bus argument cannot make it grow
+ * without bound.
+ */
+class CpuMask
+{
+public:
+    static constexpr int MAX_CPUS = 8192;
+
+    CpuMask() = default;
+
+    static CpuMask fromCpuList(const char *data, qsizetype size)
+    {
+        CpuMask mask;
+        qsizetype i = 0;
+
+        while (i < size) {
+            // Skip separators and trailing whitespace
+            while (i < size && (data[i] < '0' || data[i] > '9')) {
+                ++i;
+            }
+            if (i >= size) {
+                break;
+            }
+
+            // Numbers past MAX_CPUS mean the list is malformed; keep what came before
+            const int start = parseNumber(data, size, i);
+            int end = start;
+            if (i < size && data[i] == '-') {
+                ++i;
+                end = parseNumber(data, size, i);
+            }
+            if (start < 0 || end < 0) {
+                break;
+            }
+
+            for (int cpu = start; cpu <= end; ++cpu) {
+                mask.set(cpu);
+            }
+        }
+
+        return mask;
+    }
+
+    static CpuMask fromCpuList(const QByteArray &content)
+    {
+        return fromCpuList(content.constData(), content.size());
+    }
+
+    bool test(int cpu) const
+    {
+        if (cpu < 0) {
+            return false;
+        }
+        const qsizetype word = cpu / BITS_PER_WORD;
+        return word < m_words.size() && (m_words.at(word) & bit(cpu)) != 0;
+    }
+
+    void set(int cpu)
+    {
+        if (cpu < 0 || cpu >= MAX_CPUS) {
+            return;
+        }
+        const qsizetype word = cpu / BITS_PER_WORD;
+        if (word >= m_words.size()) {
+            m_words.resize(word + 1, 0);
+        }
+        m_words[word] |= bit(cpu);
+    }
+
+    // Lowest CPU in the mask, -1 if empty
+    int first() const
+    {
+        for (qsizetype word = 0; word < m_words.size(); ++word) {
+            if (m_words.at(word) != 0) {
+                return static_cast<int>(word * BITS_PER_WORD + qCountTrailingZeroBits(m_words.at(word)));
+            }
+        }
+        return -1;
+    }
+
+    void clear(int cpu)
+    {
+        const qsizetype word = cpu / BITS_PER_WORD;
+        if (cpu >= 0 && word < m_words.size()) {
+            m_words[word] &= ~bit(cpu);
+        }
+    }
+
+    bool isEmpty() const
+    {
+        for (quint64 w : m_words) {
+            if (w != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int count() const
+    {
+        int n = 0;
+        for (quint64 w : m_words) {
+            n += qPopulationCount(w);
+        }
+        return n;
+    }
+
+    // Highest CPU number + 1 that fits in the current storage
+    int capacity() const { return static_cast<int>(m_words.size() * BITS_PER_WORD); }
+
+    QList<int> toList() const
+    {
+        QList<int> result;
+        result.reserve(count());
+        for (qsizetype word = 0; word < m_words.size(); ++word) {
+            quint64 w = m_words.at(word);
+            while (w != 0) {
+                const int bitIndex = qCountTrailingZeroBits(w);
+                result.append(static_cast<int>(word * BITS_PER_WORD) + bitIndex);
+                w &= w - 1;
+            }
+        }
+        return result;
+    }
+
+    bool operator==(const CpuMask &other) const
+    {
+        const qsizetype n = qMax(m_words.size(), other.m_words.size());
+        for (qsizetype i = 0; i < n; ++i) {
+            const quint64 a = i < m_words.size() ? m_words.at(i) : 0;
+            const quint64 b = i < other.m_words.size() ? other.m_words.at(i) : 0;
+            if (a != b) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const CpuMask &other) const { return !(*this == other); }
+
+private:
+    static constexpr int BITS_PER_WORD = 64;
+
+    static quint64 bit(int cpu) { return quint64(1) << (cpu % BITS_PER_WORD); }
+
+    // Consumes all digits at @p i; -1 if the number is MAX_CPUS or more
+    static int parseNumber(const char *data, qsizetype size, qsizetype &i)
+    {
+        int value = 0;
+        while (i < size && data[i] >= '0' && data[i] <= '9') {
+            if (value >= 0) {
+                value = value * 10 + (data[i] - '0');
+                if (value >= MAX_CPUS) {
+                    value = -1;
+                }
+            }
+            ++i;
+        }
+        return value;
+    }
+
+    QList<quint64> m_words;
+};
+
+#endif // CPUMASK_H
@@ -16,30 +16,40 @@ CpuSettings::CpuSettings(int cpu, DbusHelper *dbus, SysfsReader *sysfs, QObject
 
 void CpuSettings::loadFromSystem()
 {
+    // Reuse the snapshot of the current sweep if the model just took one
+    const CpuSnapshot *last = m_sysfs->lastSnapshot(m_cpu);
+    const CpuSnapshot snap = last ? *last : m_sysfs->snapshot(m_cpu);
+
     // Hardware limits (constant)
-    auto limits = m_sysfs->freqLimits(m_cpu);
-    m_freqMinHw = limits.first;
-    m_freqMaxHw = limits.second;
+    m_freqMinHw = snap.hwMin;
+    m_freqMaxHw = snap.hwMax;
 
     // Available governors and energy prefs
     m_governors = m_sysfs->availableGovernors(m_cpu);
     m_energyPrefs = m_sysfs->availableEnergyPrefs(m_cpu);
-    m_energyPrefAvailable = m_sysfs->isEnergyPrefAvailable(m_cpu);
+    m_energyPrefAvailable = snap.energyPrefAvailable;
     m_freqSteps = m_sysfs->availableFrequencies(m_cpu);
-    m_canGoOffline = m_dbus->cpuAllowedOffline(m_cpu);
+    m_canGoOffline = m_sysfs->cpuAllowedOffline(m_cpu);
 
     // Current values from system
-    updateFromSystem();
+    m_origOnline = snap.online();
+    updateFromSnapshot(snap);
 }
 
 void CpuSettings::updateFromSystem()
 {
-    auto scalingFreqs = m_sysfs->scalingFreqs(m_cpu);
-    m_origFreqMin = scalingFreqs.first;
-    m_origFreqMax = scalingFreqs.second;
-    m_origGovernor = m_sysfs->currentGovernor(m_cpu);
-    m_origEnergyPref = m_sysfs->currentEnergyPref(m_cpu);
-    m_origOnline = m_sysfs->isOnline(m_cpu);
+    updateFromSnapshot(m_sysfs->snapshot(m_cpu));
+}
+
+void CpuSettings::updateFromSnapshot(const CpuSnapshot &snap)
+{
+    const bool onlineStateChanged = m_origOnline != snap.online();
+
+    m_origFreqMin = snap.scalingMin;
+    m_origFreqMax = snap.scalingMax;
+    m_origGovernor = m_sysfs->internedString(snap.governorId);
+    m_origEnergyPref = m_sysfs->internedString(snap.energyPrefId);
+    m_origOnline = snap.online();
 
     // Also update new values
     m_newFreqMin = m_origFreqMin;
@@ -48,8 +58,10 @@ void CpuSettings::updateFromSystem()
     m_newEnergyPref = m_origEnergyPref;
     m_newOnline = m_origOnline;
 
-    // Update available governors (may change when CPU goes online/offline)
-    m_governors = m_sysfs->availableGovernors(m_cpu);
+    // Available governors may change when the CPU goes online/offline
+    if (onlineStateChanged || m_governors.isEmpty()) {
+        m_governors = m_sysfs->availableGovernors(m_cpu);
+    }
 
     emitChangedSignals();
 }
@@ -224,7 +236,8 @@ int CpuSettings::applyChanges()
             ret = m_dbus->setCpuOffline(m_cpu);
         }
 
-        if (ret != 0) {
+        // HelperStatus::Unchanged is positive and not an error
+        if (ret < 0) {
             return ret;
         }
     }
@@ -233,21 +246,21 @@ int CpuSettings::applyChanges()
     if (m_newOnline) {
         if (isFreqChanged()) {
             ret = m_dbus->updateCpuSettings(m_cpu, m_newFreqMin, m_newFreqMax);
-            if (ret != 0) {
+            if (ret < 0) {
                 return -13; // Setting frequencies failed
             }
         }
 
         if (isGovernorChanged()) {
             ret = m_dbus->updateCpuGovernor(m_cpu, m_newGovernor);
-            if (ret != 0) {
+            if (ret < 0) {
                 return -11; // Setting governor failed
             }
         }
 
         if (isEnergyPrefChanged() && m_energyPrefAvailable) {
             ret = m_dbus->updateCpuEnergyPrefs(m_cpu, m_newEnergyPref);
-            if (ret != 0) {
+            if (ret < 0) {
                 return -12; // Setting energy preferences failed
             }
         }
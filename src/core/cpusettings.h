@@ -11,6 +11,7 @@
 
 class DbusHelper;
 class SysfsReader;
+struct CpuSnapshot;
 
 /**
  * @brief Per-CPU settings state management
@@ -104,6 +105,7 @@ public:
     // Actions
     Q_INVOKABLE void resetToSystem();
     Q_INVOKABLE void updateFromSystem();
+    void updateFromSnapshot(const CpuSnapshot &snap);
     Q_INVOKABLE int applyChanges();
 
     // Available frequency steps for slider marks
@@ -6,11 +6,19 @@
 #include <QDBusReply>
 #include <QDBusMetaType>
 #include <QDBusPendingReply>
+#include <QMap>
 #include <QDebug>
 
 DbusHelper::DbusHelper(QObject *parent)
     : QObject(parent)
 {
+    qDBusRegisterMetaType<PlanEntry>();
+    qDBusRegisterMetaType<QList<PlanEntry>>();
+    qDBusRegisterMetaType<CpuState>();
+    qDBusRegisterMetaType<QList<CpuState>>();
+    qDBusRegisterMetaType<EffectiveFreq>();
+    qDBusRegisterMetaType<QList<EffectiveFreq>>();
+
     connectToService();
 }
 
@@ -30,6 +38,12 @@ void DbusHelper::connectToService()
     );
 
     m_connected = m_interface->isValid();
+
+    // Works even before the helper is activated: the match is on the well-known name
+    QDBusConnection::systemBus().connect(
+        SERVICE_NAME, OBJECT_PATH, INTERFACE_NAME, QStringLiteral("CpuStateChanged"),
+        this, SLOT(onCpuStateChanged(QList<int>,uint)));
+
     if (!m_connected) {
         qWarning() << "Failed to connect to D-Bus service:" << SERVICE_NAME;
         qWarning() << "Error:" << m_interface->lastError().message();
@@ -44,26 +58,11 @@ bool DbusHelper::isConnected() const
     return m_connected;
 }
 
-bool DbusHelper::isAuthorized()
-{
-    if (!m_connected) {
-        return false;
-    }
-
-    QDBusReply<int> reply = m_interface->call(QStringLiteral("isauthorized"));
-    if (reply.isValid()) {
-        return reply.value() != 0;
-    }
-
-    qWarning() << "isauthorized call failed:" << reply.error().message();
-    return false;
-}
-
-QVariant DbusHelper::callMethod(const QString &method, const QVariantList &args)
+QDBusMessage DbusHelper::callMessage(const QString &method, const QVariantList &args)
 {
     if (!m_connected) {
         Q_EMIT operationFailed(tr("Not connected to D-Bus service"));
-        return QVariant();
+        return QDBusMessage();
     }
 
     QDBusMessage msg = m_interface->callWithArgumentList(QDBus::Block, method, args);
@@ -72,10 +71,16 @@ QVariant DbusHelper::callMethod(const QString &method, const QVariantList &args)
         QString error = msg.errorMessage();
         qWarning() << "D-Bus call failed:" << method << "-" << error;
         Q_EMIT operationFailed(error);
-        return QVariant();
     }
 
-    if (msg.arguments().isEmpty()) {
+    return msg;
+}
+
+QVariant DbusHelper::callMethod(const QString &method, const QVariantList &args)
+{
+    const QDBusMessage msg = callMessage(method, args);
+
+    if (msg.type() != QDBusMessage::ReplyMessage || msg.arguments().isEmpty()) {
         return QVariant();
     }
 
@@ -108,9 +113,22 @@ void DbusHelper::processNextOperation()
         // If we were in batch mode, emit completion signal
         if (m_batchMode) {
             m_batchMode = false;
-            Q_EMIT batchCompleted(!m_batchHadErrors, m_batchErrors);
+
+            // Refresh what no CpuStateChanged covered before reporting the batch
+            CpuMask unreported;
+            for (int cpu : m_batchWritten.toList()) {
+                if (!m_batchNotified.test(cpu)) {
+                    unreported.set(cpu);
+                }
+            }
+            if (!unreported.isEmpty()) {
+                Q_EMIT cpuStateChanged(unreported.toList(), CpuField::All);
+            }
+
+            Q_EMIT batchCompleted(!m_batchHadErrors, m_batchErrors, m_batchWrites);
             m_batchErrors.clear();
             m_batchHadErrors = false;
+            m_batchWrites = 0;
         }
         return;
     }
@@ -141,16 +159,29 @@ void DbusHelper::processNextOperation()
     );
     msg.setArguments(op.args);
 
-    QDBusPendingCall pendingCall = QDBusConnection::systemBus().asyncCall(msg);
+    // The helper only answers once the user has dealt with the polkit prompt
+    QDBusPendingCall pendingCall = QDBusConnection::systemBus().asyncCall(msg, MUTATION_TIMEOUT_MS);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
     
     // Store the description in the watcher for error reporting
     watcher->setProperty("operationDescription", op.description);
+    watcher->setProperty("operationCpu", op.args.value(0).toInt());
     
     connect(watcher, &QDBusPendingCallWatcher::finished,
             this, &DbusHelper::onAsyncCallFinished);
 }
 
+void DbusHelper::onCpuStateChanged(const QList<int> &cpus, uint fields)
+{
+    qDebug() << "Helper reports" << cpus.size() << "changed CPUs, fields" << Qt::hex << fields;
+    if (m_batchMode) {
+        for (int cpu : cpus) {
+            m_batchNotified.set(cpu);
+        }
+    }
+    Q_EMIT cpuStateChanged(cpus, fields);
+}
+
 void DbusHelper::onAsyncCallFinished(QDBusPendingCallWatcher *watcher)
 {
     QString description = watcher->property("operationDescription").toString();
@@ -164,8 +195,16 @@ void DbusHelper::onAsyncCallFinished(QDBusPendingCallWatcher *watcher)
         Q_EMIT operationFailed(error);
     } else {
         int result = reply.value();
-        if (result == 0) {
-            qDebug() << "Async D-Bus call succeeded:" << description;
+        if (result >= 0) {
+            qDebug() << "Async D-Bus call succeeded:" << description
+                     << (result == HelperStatus::Unchanged ? "(unchanged)" : "");
+            if (result == HelperStatus::Ok) {
+                // Single calls do not report their write count; count the call
+                ++m_batchWrites;
+                if (m_batchMode) {
+                    m_batchWritten.set(watcher->property("operationCpu").toInt());
+                }
+            }
             Q_EMIT operationSucceeded();
         } else {
             QString error = tr("Operation failed with code %1").arg(result);
@@ -187,6 +226,9 @@ void DbusHelper::beginBatch()
     m_batchMode = true;
     m_batchErrors.clear();
     m_batchHadErrors = false;
+    m_batchWrites = 0;
+    m_batchWritten = CpuMask();
+    m_batchNotified = CpuMask();
 }
 
 void DbusHelper::endBatch()
@@ -194,75 +236,244 @@ void DbusHelper::endBatch()
     // If nothing was queued, emit completion immediately
     if (m_operationQueue.isEmpty() && !m_operationInProgress) {
         m_batchMode = false;
-        Q_EMIT batchCompleted(true, QStringList());
+        Q_EMIT batchCompleted(true, QStringList(), 0);
         return;
     }
     
     // Otherwise, start processing the queue
     if (!m_operationInProgress) {
-        processNextOperation();
+        if (m_connected && m_planSupported) {
+            sendPlan();
+        } else {
+            processNextOperation();
+        }
     }
     // When queue empties, processNextOperation will emit batchCompleted
 }
 
-QList<int> DbusHelper::cpusAvailable()
+void DbusHelper::applyPlanAsync(const QList<PlanEntry> &plan)
 {
-    QList<int> result;
-    QVariant reply = callMethod(QStringLiteral("get_cpus_available"));
-
-    if (reply.isValid()) {
-        const QVariantList list = reply.toList();
-        for (const QVariant &v : list) {
-            result.append(v.toInt());
+    beginBatch();
+
+    // Split into single operations so helpers without apply_plan still work;
+    // sendPlan() folds them back into these entries
+    for (const PlanEntry &entry : plan) {
+        if (entry.cpu != 0) {
+            if (entry.online) {
+                setCpuOnlineAsync(entry.cpu);
+            } else {
+                setCpuOfflineAsync(entry.cpu);
+                continue;
+            }
+        }
+        if (entry.hasFrequencies()) {
+            updateCpuSettingsAsync(entry.cpu, entry.freqMin, entry.freqMax);
+        }
+        if (!entry.governor.isEmpty()) {
+            updateCpuGovernorAsync(entry.cpu, entry.governor);
+        }
+        if (!entry.energyPref.isEmpty()) {
+            updateCpuEnergyPrefsAsync(entry.cpu, entry.energyPref);
         }
     }
 
-    return result;
+    endBatch();
 }
 
-QList<int> DbusHelper::cpusOnline()
+void DbusHelper::sendPlan()
 {
-    QList<int> result;
-    QVariant reply = callMethod(QStringLiteral("get_cpus_online"));
+    setOperationInProgress(true);
 
-    if (reply.isValid()) {
-        const QVariantList list = reply.toList();
-        for (const QVariant &v : list) {
-            result.append(v.toInt());
+    // Fold the per-attribute operations into one entry per CPU
+    QMap<int, PlanEntry> entries;
+    m_planOperations.clear();
+
+    while (!m_operationQueue.isEmpty()) {
+        const QueuedOperation op = m_operationQueue.dequeue();
+        const int cpu = op.args.value(0).toInt();
+
+        PlanEntry &entry = entries[cpu];
+        entry.cpu = cpu;
+
+        if (op.method == QLatin1String("update_cpu_settings")) {
+            entry.freqMin = op.args.value(1).toInt();
+            entry.freqMax = op.args.value(2).toInt();
+        } else if (op.method == QLatin1String("update_cpu_governor")) {
+            entry.governor = op.args.value(1).toString();
+        } else if (op.method == QLatin1String("update_cpu_energy_prefs")) {
+            entry.energyPref = op.args.value(1).toString();
+        } else if (op.method == QLatin1String("set_cpu_online")) {
+            entry.online = true;
+        } else if (op.method == QLatin1String("set_cpu_offline")) {
+            entry.online = false;
         }
+
+        m_planOperations.append(op);
     }
 
-    return result;
+    m_pendingPlan = entries.values();
+
+    qDebug() << "Sending apply_plan with" << m_pendingPlan.size() << "entries built from"
+             << m_planOperations.size() << "operations";
+
+    QDBusMessage msg = QDBusMessage::createMethodCall(
+        SERVICE_NAME,
+        OBJECT_PATH,
+        INTERFACE_NAME,
+        QStringLiteral("apply_plan")
+    );
+    msg.setArguments({QVariant::fromValue(m_pendingPlan)});
+
+    // The helper only answers once the user has dealt with the polkit prompt
+    QDBusPendingCall pendingCall = QDBusConnection::systemBus().asyncCall(msg, MUTATION_TIMEOUT_MS);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
+
+    connect(watcher, &QDBusPendingCallWatcher::finished,
+            this, &DbusHelper::onPlanFinished);
 }
 
-QList<int> DbusHelper::cpusOffline()
+void DbusHelper::failPlanOperations(int cpu, const QString &error)
 {
-    QList<int> result;
-    QVariant reply = callMethod(QStringLiteral("get_cpus_offline"));
+    m_batchHadErrors = true;
 
-    if (reply.isValid()) {
-        const QVariantList list = reply.toList();
-        for (const QVariant &v : list) {
-            result.append(v.toInt());
+    for (const QueuedOperation &op : std::as_const(m_planOperations)) {
+        if (cpu < 0 || op.args.value(0).toInt() == cpu) {
+            m_batchErrors.append(op.description + QStringLiteral(": ") + error);
         }
     }
+}
 
-    return result;
+void DbusHelper::onPlanFinished(QDBusPendingCallWatcher *watcher)
+{
+    QDBusPendingReply<QList<int>, int> reply = *watcher;
+    watcher->deleteLater();
+
+    if (reply.isError()) {
+        if (reply.error().type() == QDBusError::UnknownMethod) {
+            // Older helper: replay the batch one operation at a time
+            qDebug() << "Helper does not support apply_plan, sending single operations";
+            m_planSupported = false;
+            for (const QueuedOperation &op : std::as_const(m_planOperations)) {
+                m_operationQueue.enqueue(op);
+            }
+        } else {
+            QString error = reply.error().message();
+            qWarning() << "apply_plan failed:" << error;
+            failPlanOperations(-1, error);
+            Q_EMIT operationFailed(error);
+        }
+    } else {
+        const QList<int> statuses = reply.argumentAt<0>();
+        m_batchWrites += reply.argumentAt<1>();
+        bool failed = false;
+
+        for (qsizetype i = 0; i < m_pendingPlan.size(); ++i) {
+            const int status = statuses.value(i, HelperStatus::WriteFailed);
+            if (status == HelperStatus::Ok) {
+                m_batchWritten.set(m_pendingPlan.at(i).cpu);
+            } else if (status < 0) {
+                const int cpu = m_pendingPlan.at(i).cpu;
+                qWarning() << "apply_plan entry for CPU" << cpu << "returned" << status;
+                failPlanOperations(cpu, tr("Operation failed with code %1").arg(status));
+                failed = true;
+            }
+        }
+
+        if (failed) {
+            Q_EMIT operationFailed(tr("Some CPUs could not be updated"));
+        } else {
+            Q_EMIT operationSucceeded();
+        }
+    }
+
+    m_pendingPlan.clear();
+    m_planOperations.clear();
+
+    // Runs any fallback operations, then reports the batch
+    processNextOperation();
+}
+
+QList<int> DbusHelper::cpuList(const QString &method)
+{
+    // Demarshalled straight from "ai", without a QVariant per element
+    const QDBusReply<QList<int>> reply = callMessage(method);
+    return reply.isValid() ? reply.value() : QList<int>();
+}
+
+QList<int> DbusHelper::cpusAvailable()
+{
+    return cpuList(QStringLiteral("get_cpus_available"));
+}
+
+QList<int> DbusHelper::cpusOnline()
+{
+    return cpuList(QStringLiteral("get_cpus_online"));
+}
+
+QList<int> DbusHelper::cpusOffline()
+{
+    return cpuList(QStringLiteral("get_cpus_offline"));
 }
 
 QList<int> DbusHelper::cpusPresent()
 {
-    QList<int> result;
-    QVariant reply = callMethod(QStringLiteral("get_cpus_present"));
+    return cpuList(QStringLiteral("get_cpus_present"));
+}
 
-    if (reply.isValid()) {
-        const QVariantList list = reply.toList();
-        for (const QVariant &v : list) {
-            result.append(v.toInt());
+QList<CpuState> DbusHelper::stateAll()
+{
+    const QDBusReply<QList<CpuState>> reply = callMessage(QStringLiteral("get_state_all"));
+    return reply.isValid() ? reply.value() : QList<CpuState>();
+}
+
+void DbusHelper::requestEffectiveFrequencies(const QList<int> &cpus, uint windowMs)
+{
+    if (!m_connected || !m_effectiveFreqsSupported || m_effectiveFreqsPending) {
+        return;
+    }
+
+    QDBusMessage msg = QDBusMessage::createMethodCall(
+        SERVICE_NAME,
+        OBJECT_PATH,
+        INTERFACE_NAME,
+        QStringLiteral("get_effective_freqs")
+    );
+    msg.setArguments({QVariant::fromValue(cpus), QVariant::fromValue(windowMs)});
+
+    m_effectiveFreqsPending = true;
+    QDBusPendingCall pendingCall = QDBusConnection::systemBus().asyncCall(msg);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pendingCall, this);
+
+    connect(watcher, &QDBusPendingCallWatcher::finished,
+            this, &DbusHelper::onEffectiveFrequenciesFinished);
+}
+
+void DbusHelper::onEffectiveFrequenciesFinished(QDBusPendingCallWatcher *watcher)
+{
+    QDBusPendingReply<QList<EffectiveFreq>> reply = *watcher;
+    watcher->deleteLater();
+    m_effectiveFreqsPending = false;
+
+    if (reply.isError()) {
+        if (reply.error().type() == QDBusError::UnknownMethod) {
+            qDebug() << "Helper does not support get_effective_freqs";
+            m_effectiveFreqsSupported = false;
+        } else if (reply.error().type() == QDBusError::LimitsExceeded) {
+            qDebug() << "get_effective_freqs rate limited by the helper";
+        } else {
+            qWarning() << "get_effective_freqs failed:" << reply.error().message();
         }
+        return;
     }
 
-    return result;
+    const QList<EffectiveFreq> freqs = reply.value();
+    if (freqs.isEmpty()) {
+        // No msr module or no permission; asking again won't help
+        qDebug() << "Helper cannot read APERF/MPERF, effective frequencies disabled";
+        m_effectiveFreqsSupported = false;
+    }
+
+    Q_EMIT effectiveFrequenciesReady(freqs);
 }
 
 QStringList DbusHelper::getCpuGovernors(int cpu)
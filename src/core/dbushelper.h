@@ -14,6 +14,9 @@
 #include <QQueue>
 #include <functional>
 
+#include "cpumask.h"
+#include "helperprotocol.h"
+
 /**
  * @brief D-Bus helper class for communicating with cpupower-gui-helper service
  * 
@@ -21,12 +24,12 @@
  * service which runs as root and performs privileged operations on CPU settings.
  * 
  * Mutation operations are asynchronous to avoid blocking the UI during PolicyKit
- * authentication prompts.
+ * authentication prompts. Operations queued between beginBatch() and endBatch()
+ * are folded into one plan entry per CPU and sent in a single apply_plan call.
  */
 class DbusHelper : public QObject
 {
     Q_OBJECT
-    Q_PROPERTY(bool authorized READ isAuthorized NOTIFY authorizedChanged)
     Q_PROPERTY(bool connected READ isConnected NOTIFY connectedChanged)
     Q_PROPERTY(bool operationInProgress READ isOperationInProgress NOTIFY operationInProgressChanged)
 
@@ -36,7 +39,6 @@ public:
 
     // Connection status
     bool isConnected() const;
-    bool isAuthorized();
     bool isOperationInProgress() const { return m_operationInProgress; }
 
     // CPU queries (synchronous - no auth needed)
@@ -46,6 +48,12 @@ public:
     Q_INVOKABLE QList<int> cpusPresent();
     Q_INVOKABLE QStringList getCpuGovernors(int cpu);
     Q_INVOKABLE bool cpuAllowedOffline(int cpu);
+    // Every present CPU in one round-trip (get_state_all)
+    QList<CpuState> stateAll();
+    // Measure delivered frequencies over @p windowMs (get_effective_freqs).
+    // Answered by effectiveFrequenciesReady(); ignored while a request is in
+    // flight or once the helper turned out not to support it.
+    void requestEffectiveFrequencies(const QList<int> &cpus, uint windowMs);
 
     // CPU mutations (asynchronous - may trigger PolicyKit auth)
     // These queue operations and execute them sequentially
@@ -55,11 +63,15 @@ public:
     Q_INVOKABLE void setCpuOnlineAsync(int cpu);
     Q_INVOKABLE void setCpuOfflineAsync(int cpu);
 
-    // Batch operations - queue multiple and signal when all complete
+    // Batch operations - queue multiple and signal when all complete.
+    // Every CPU in a batch is brought online unless it is set offline.
     void beginBatch();
     void endBatch();  // Will emit batchCompleted when all queued operations finish
+    // Queue every field of @p plan as one batch (emits batchCompleted)
+    void applyPlanAsync(const QList<PlanEntry> &plan);
 
-    // Synchronous versions (for internal use, may block)
+    // Synchronous versions (for internal use, may block). They return a
+    // HelperStatus code: Ok if written, Unchanged if already set, negative on failure
     int updateCpuSettings(int cpu, int fmin, int fmax);
     int updateCpuGovernor(int cpu, const QString &governor);
     int updateCpuEnergyPrefs(int cpu, const QString &pref);
@@ -67,17 +79,28 @@ public:
     int setCpuOffline(int cpu);
 
 signals:
-    void authorizedChanged();
     void connectedChanged();
     void operationInProgressChanged();
     void operationFailed(const QString &error);
     void operationSucceeded();
-    void batchCompleted(bool allSucceeded, const QStringList &errors);
+    // writesPerformed counts sysfs writes (values already in place are not
+    // rewritten) when the helper supports apply_plan. Older helpers only
+    // report whether a call changed anything, so there it counts the calls
+    // that did; one update_cpu_settings call may write two files.
+    void batchCompleted(bool allSucceeded, const QStringList &errors, int writesPerformed);
     void helperReady(bool ready);
+    // Forwarded from the helper's CpuStateChanged signal (CpuField bits).
+    // Before batchCompleted it is also emitted (with CpuField::All) for CPUs
+    // the batch changed but the helper did not report, e.g. older helpers.
+    void cpuStateChanged(const QList<int> &cpus, uint fields);
+    void effectiveFrequenciesReady(const QList<EffectiveFreq> &freqs);
     void errorOccurred(const QString &error);
 
 private slots:
+    void onCpuStateChanged(const QList<int> &cpus, uint fields);
     void onAsyncCallFinished(QDBusPendingCallWatcher *watcher);
+    void onPlanFinished(QDBusPendingCallWatcher *watcher);
+    void onEffectiveFrequenciesFinished(QDBusPendingCallWatcher *watcher);
 
 private:
     struct QueuedOperation {
@@ -87,9 +110,13 @@ private:
     };
 
     void connectToService();
+    QDBusMessage callMessage(const QString &method, const QVariantList &args = {});
     QVariant callMethod(const QString &method, const QVariantList &args = {});
+    QList<int> cpuList(const QString &method);
     void queueOperation(const QString &method, const QVariantList &args, const QString &description);
     void processNextOperation();
+    void sendPlan();
+    void failPlanOperations(int cpu, const QString &error);
     void setOperationInProgress(bool inProgress);
 
     QDBusInterface *m_interface = nullptr;
@@ -99,6 +126,22 @@ private:
     QQueue<QueuedOperation> m_operationQueue;
     QStringList m_batchErrors;
     bool m_batchHadErrors = false;
+    int m_batchWrites = 0;          // Sysfs writes, or changing calls (see batchCompleted)
+    // CPUs the batch wrote to, and CPUs the helper reported changed meanwhile
+    CpuMask m_batchWritten;
+    CpuMask m_batchNotified;
+
+    // Plan in flight and the operations it was built from (for error reporting
+    // and for falling back to single calls on helpers without apply_plan)
+    QList<PlanEntry> m_pendingPlan;
+    QList<QueuedOperation> m_planOperations;
+    bool m_planSupported = true;
+
+    bool m_effectiveFreqsPending = false;
+    bool m_effectiveFreqsSupported = true;
+
+    // Matches the helper's polkit timeout, mutations wait for the prompt
+    static constexpr int MUTATION_TIMEOUT_MS = 120000;
 
     static constexpr const char *SERVICE_NAME = "io.github.cpupower_gui.qt.helper";
     static constexpr const char *OBJECT_PATH = "/io/github/cpupower_gui/qt/helper";
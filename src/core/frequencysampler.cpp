@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "frequencysampler.h"
+#include "cpumask.h"
+#include "sysfsbackend.h"
+
+#include <QTimer>
+#include <QDebug>
+
+#include <cstdlib>
+
+FrequencySampler::FrequencySampler(SysfsBackend *backend, QObject *parent)
+    : QObject(parent)
+    , m_backend(backend)
+    , m_timer(new QTimer())
+{
+    m_thread.setObjectName(QStringLiteral("FrequencySampler"));
+
+    // The timer fires in the sampler thread, so sample() runs there too
+    m_timer->moveToThread(&m_thread);
+    connect(m_timer, &QTimer::timeout, m_timer, [this]() {
+        sample();
+    });
+}
+
+FrequencySampler::~FrequencySampler()
+{
+    stop();
+    closeHandles();
+    delete m_timer;
+}
+
+void FrequencySampler::setCpus(const QList<int> &cpus)
+{
+    const bool running = isRunning();
+    stop();
+
+    closeHandles();
+    m_cpus = cpus;
+    m_handles.fill(-1, m_cpus.size());
+    m_procStat.setCpus(m_cpus);
+    for (auto &buffer : m_buffers) {
+        buffer.reset(new std::atomic<int>[LANES * m_cpus.size()]());
+    }
+    m_published.store(0, std::memory_order_relaxed);
+
+    if (running) {
+        start();
+    }
+}
+
+void FrequencySampler::setInterval(int ms)
+{
+    m_intervalMs = ms;
+    if (isRunning()) {
+        QMetaObject::invokeMethod(m_timer, [this, ms]() {
+            m_timer->setInterval(ms);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void FrequencySampler::start()
+{
+    if (isRunning() || m_cpus.isEmpty()) {
+        return;
+    }
+
+    m_thread.start();
+    QMetaObject::invokeMethod(m_timer, [this, interval = m_intervalMs]() {
+        sample();
+        m_timer->start(interval);
+    }, Qt::QueuedConnection);
+}
+
+void FrequencySampler::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(m_timer, &QTimer::stop, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+}
+
+bool FrequencySampler::latest(QList<int> &khz) const
+{
+    QList<int> *const lanes[] = {&khz};
+    return readLatest(lanes, 1);
+}
+
+bool FrequencySampler::latest(QList<int> &khz, QList<int> &busyPermille, QList<int> &iowaitPermille) const
+{
+    QList<int> *const lanes[] = {&khz, &busyPermille, &iowaitPermille};
+    return readLatest(lanes, LANES);
+}
+
+bool FrequencySampler::readLatest(QList<int> *const *lanes, int laneCount) const
+{
+    const qsizetype count = m_cpus.size();
+
+    for (int attempt = 0; attempt < READ_RETRIES; ++attempt) {
+        const quint64 published = m_published.load(std::memory_order_acquire);
+        if (published == 0) {
+            return false;
+        }
+
+        const std::atomic<int> *front = m_buffers[published & 1].get();
+        for (int lane = 0; lane < laneCount; ++lane) {
+            QList<int> &values = *lanes[lane];
+            const std::atomic<int> *source = front + lane * count;
+            values.resize(count);
+            for (qsizetype i = 0; i < count; ++i) {
+                values[i] = source[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        // The writer only reuses this half after publishing the other one,
+        // so the copy is consistent if nothing was published meanwhile
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_published.load(std::memory_order_relaxed) == published) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void FrequencySampler::sample()
+{
+    char buf[SysfsBackend::PAGE_SIZE_LIMIT];
+
+    // One read of the online list per tick; cpufreq of offline CPUs is gone
+    if (m_onlineHandle < 0) {
+        m_onlineHandle = m_backend->open(QStringLiteral("online"));
+    }
+    const qsizetype onlineSize = m_onlineHandle >= 0 ? m_backend->readAt(m_onlineHandle, buf, sizeof(buf)) : -1;
+    const bool haveMask = onlineSize > 0;
+    const CpuMask online = haveMask ? CpuMask::fromCpuList(buf, onlineSize) : CpuMask();
+
+    const quint64 published = m_published.load(std::memory_order_relaxed);
+    std::atomic<int> *back = m_buffers[(published + 1) & 1].get();
+
+    // The back half is what a reader may still be copying from before the
+    // last publish; pairs with the acquire fence in readLatest() so a reader
+    // that sees any of the stores below also sees that publish and retries
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (qsizetype i = 0; i < m_cpus.size(); ++i) {
+        const int cpu = m_cpus.at(i);
+        int &handle = m_handles[i];
+        int khz = 0;
+
+        if (!haveMask || online.test(cpu)) {
+            if (handle < 0) {
+                handle = m_backend->open(QStringLiteral("cpu%1/cpufreq/scaling_cur_freq").arg(cpu));
+            }
+            if (handle >= 0) {
+                char value[32];
+                const qsizetype size = m_backend->readAt(handle, value, sizeof(value) - 1);
+                if (size > 0) {
+                    value[size] = '\0';
+                    khz = int(std::strtol(value, nullptr, 10));
+                } else {
+                    // Stale after hotplug; reopen on the next tick
+                    m_backend->close(handle);
+                    handle = -1;
+                }
+            }
+        } else if (handle >= 0) {
+            m_backend->close(handle);
+            handle = -1;
+        }
+
+        back[i].store(khz, std::memory_order_relaxed);
+    }
+
+    // Load of all CPUs from a single read of /proc/stat
+    const qsizetype count = m_cpus.size();
+    const bool haveLoad = m_procStat.sample();
+    for (qsizetype i = 0; i < count; ++i) {
+        back[count + i].store(haveLoad ? m_procStat.busyPermille(i) : 0, std::memory_order_relaxed);
+        back[2 * count + i].store(haveLoad ? m_procStat.iowaitPermille(i) : 0, std::memory_order_relaxed);
+    }
+
+    m_published.store(published + 1, std::memory_order_release);
+    Q_EMIT sampleReady();
+}
+
+void FrequencySampler::closeHandles()
+{
+    for (int &handle : m_handles) {
+        if (handle >= 0) {
+            m_backend->close(handle);
+            handle = -1;
+        }
+    }
+    if (m_onlineHandle >= 0) {
+        m_backend->close(m_onlineHandle);
+        m_onlineHandle = -1;
+    }
+}
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef FREQUENCYSAMPLER_H
+#define FREQUENCYSAMPLER_H
+
+#include <QObject>
+#include <QList>
+#include <QThread>
+
+#include <atomic>
+#include <memory>
+
+#include "procstatsampler.h"
+
+class QTimer;
+class SysfsBackend;
+
+/**
+ * @brief Samples scaling_cur_freq and load of a list of CPUs on a background thread
+ *
+ * Each tick reads the online mask, the current frequency of every CPU and
+ * /proc/stat (once, for all CPUs) into the back half of a double buffer, then publishes it by bumping an
+ * atomic sequence number whose lowest bit selects the front half. Readers
+ * copy the front half without locking and retry if a newer sample was
+ * published meanwhile. sampleReady() is emitted from the sampler thread,
+ * so receivers on the GUI thread get it queued and never touch sysfs.
+ *
+ * setCpus(), start(), stop() and latest() must be called from the thread
+ * that owns the sampler. The backend must be thread-safe and outlive it.
+ */
+class FrequencySampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrequencySampler(SysfsBackend *backend, QObject *parent = nullptr);
+    ~FrequencySampler() override;
+
+    // CPUs to sample, in the order of the published values (model rows).
+    // Restarts the thread if it was running.
+    void setCpus(const QList<int> &cpus);
+    QList<int> cpus() const { return m_cpus; }
+
+    void setInterval(int ms);
+    int interval() const { return m_intervalMs; }
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_thread.isRunning(); }
+
+    // Copies the newest sample (kHz per CPU, 0 if offline) into @p khz.
+    // Returns false if nothing has been published yet.
+    bool latest(QList<int> &khz) const;
+    // Same sample with the busy and iowait shares (per mille) since the previous tick
+    bool latest(QList<int> &khz, QList<int> &busyPermille, QList<int> &iowaitPermille) const;
+
+Q_SIGNALS:
+    void sampleReady();
+
+private:
+    void sample();                  // Sampler thread
+    void closeHandles();
+    bool readLatest(QList<int> *const *lanes, int laneCount) const;
+
+    SysfsBackend *m_backend;
+    QThread m_thread;
+    QTimer *m_timer;                // Lives in m_thread
+    int m_intervalMs = DEFAULT_INTERVAL_MS;
+
+    // Only touched by the sampler thread while it runs
+    QList<int> m_cpus;
+    QList<int> m_handles;
+    int m_onlineHandle = -1;
+    ProcStatSampler m_procStat;
+
+    // Published double buffer of LANES lanes of m_cpus.size() values each
+    // (kHz, busy, iowait); std::atomic elements keep concurrent reads defined
+    std::unique_ptr<std::atomic<int>[]> m_buffers[2];
+    std::atomic<quint64> m_published{0};    // Number of samples published
+
+    static constexpr int DEFAULT_INTERVAL_MS = 500;
+    static constexpr int READ_RETRIES = 3;
+    static constexpr int LANES = 3;
+};
+
+#endif // FREQUENCYSAMPLER_H
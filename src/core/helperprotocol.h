@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef HELPERPROTOCOL_H
+#define HELPERPROTOCOL_H
+
+#include <QDBusArgument>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+
+/**
+ * @brief Types shared by DbusHelper and the helper service
+ *
+ * Header-only so the helper, which is built on its own, can use it too.
+ */
+
+// Status codes returned by the helper, per plan entry for apply_plan
+namespace HelperStatus {
+enum Code : int {
+    Unchanged = 1,          // Value was already set, nothing written
+    Ok = 0,                 // Applied
+    NotAuthorized = -1,
+    NotPresent = -2,        // CPU does not exist
+    CannotOffline = -3,     // CPU has no online attribute (usually CPU 0)
+    NoProfile = -4,         // The configured default profile does not exist
+    WriteFailed = -13       // The kernel rejected a value
+};
+}
+
+// Bits of the fieldMask argument of the helper's CpuStateChanged signal
+namespace CpuField {
+enum Flag : uint {
+    Frequencies = 0x1,      // scaling_min_freq / scaling_max_freq
+    Governor = 0x2,
+    EnergyPref = 0x4,
+    Online = 0x8,           // Hotplug; the CPU's whole state may differ
+    All = 0xf
+};
+}
+
+/**
+ * @brief Desired state of one CPU, D-Bus signature (iiissb)
+ *
+ * Zero frequencies and empty strings leave the attribute untouched. A CPU with
+ * online == false is taken offline and its other fields are ignored; otherwise
+ * it is brought online first if needed.
+ */
+struct PlanEntry {
+    int cpu = -1;
+    int freqMin = 0;        // kHz
+    int freqMax = 0;        // kHz
+    QString governor;
+    QString energyPref;
+    bool online = true;
+
+    bool hasFrequencies() const { return freqMin > 0 && freqMax > 0; }
+
+    // CpuField bits this entry asks to change (besides the online state)
+    uint fields() const
+    {
+        uint result = 0;
+        if (hasFrequencies()) {
+            result |= CpuField::Frequencies;
+        }
+        if (!governor.isEmpty()) {
+            result |= CpuField::Governor;
+        }
+        if (!energyPref.isEmpty()) {
+            result |= CpuField::EnergyPref;
+        }
+        return result;
+    }
+};
+
+Q_DECLARE_METATYPE(PlanEntry)
+
+inline QDBusArgument &operator<<(QDBusArgument &argument, const PlanEntry &entry)
+{
+    argument.beginStructure();
+    argument << entry.cpu << entry.freqMin << entry.freqMax
+             << entry.governor << entry.energyPref << entry.online;
+    argument.endStructure();
+    return argument;
+}
+
+inline const QDBusArgument &operator>>(const QDBusArgument &argument, PlanEntry &entry)
+{
+    argument.beginStructure();
+    argument >> entry.cpu >> entry.freqMin >> entry.freqMax
+             >> entry.governor >> entry.energyPref >> entry.online;
+    argument.endStructure();
+    return argument;
+}
+
+/**
+ * @brief Current state of one CPU, D-Bus signature (iiiiissb)
+ *
+ * Returned in bulk by get_state_all(). Offline CPUs have no cpufreq
+ * directory, so their frequencies are 0 and their strings empty.
+ */
+struct CpuState {
+    int cpu = -1;
+    int freqMin = 0;        // kHz, scaling limits
+    int freqMax = 0;
+    int hwMin = 0;          // kHz, cpuinfo limits
+    int hwMax = 0;
+    QString governor;
+    QString energyPref;
+    bool online = false;
+};
+
+Q_DECLARE_METATYPE(CpuState)
+
+inline QDBusArgument &operator<<(QDBusArgument &argument, const CpuState &state)
+{
+    argument.beginStructure();
+    argument << state.cpu << state.freqMin << state.freqMax << state.hwMin << state.hwMax
+             << state.governor << state.energyPref << state.online;
+    argument.endStructure();
+    return argument;
+}
+
+inline const QDBusArgument &operator>>(const QDBusArgument &argument, CpuState &state)
+{
+    argument.beginStructure();
+    argument >> state.cpu >> state.freqMin >> state.freqMax >> state.hwMin >> state.hwMax
+             >> state.governor >> state.energyPref >> state.online;
+    argument.endStructure();
+    return argument;
+}
+
+/**
+ * @brief Delivered frequency of one CPU over a window, D-Bus signature (iiid)
+ *
+ * Returned by get_effective_freqs(), derived from the APERF/MPERF/TSC deltas:
+ * avgKhz is APERF/time (idle time counts as 0 Hz), busyKhz is the frequency
+ * while in C0 (TSC rate * APERF/MPERF) and c0Residency is MPERF/TSC.
+ */
+struct EffectiveFreq {
+    int cpu = -1;
+    int avgKhz = 0;
+    int busyKhz = 0;
+    double c0Residency = 0.0;   // 0..1
+};
+
+Q_DECLARE_METATYPE(EffectiveFreq)
+
+inline QDBusArgument &operator<<(QDBusArgument &argument, const EffectiveFreq &freq)
+{
+    argument.beginStructure();
+    argument << freq.cpu << freq.avgKhz << freq.busyKhz << freq.c0Residency;
+    argument.endStructure();
+    return argument;
+}
+
+inline const QDBusArgument &operator>>(const QDBusArgument &argument, EffectiveFreq &freq)
+{
+    argument.beginStructure();
+    argument >> freq.cpu >> freq.avgKhz >> freq.busyKhz >> freq.c0Residency;
+    argument.endStructure();
+    return argument;
+}
+
+#endif // HELPERPROTOCOL_H
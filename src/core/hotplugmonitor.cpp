@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "hotplugmonitor.h"
+#include "ueventsource.h"
+
+#include <QByteArrayView>
+#include <QDebug>
+
+HotplugMonitor::HotplugMonitor(QObject *parent)
+    : HotplugMonitor(new NetlinkUeventSource(), parent)
+{
+}
+
+HotplugMonitor::HotplugMonitor(UeventSource *source, QObject *parent)
+    : QObject(parent)
+    , m_source(source)
+{
+    m_source->setParent(this);
+    connect(m_source, &UeventSource::ueventReceived, this, &HotplugMonitor::onUevent);
+    connect(m_source, &UeventSource::overflowed, this, &HotplugMonitor::eventsLost);
+}
+
+bool HotplugMonitor::start()
+{
+    if (!m_source->open()) {
+        qWarning() << "CPU hotplug monitoring unavailable, changes are picked up on refresh";
+        return false;
+    }
+    return true;
+}
+
+bool HotplugMonitor::isActive() const
+{
+    return m_source->isOpen();
+}
+
+bool HotplugMonitor::parseUevent(const QByteArray &message, int *cpu, Action *action)
+{
+    QByteArrayView actionValue;
+    QByteArrayView devpath;
+    QByteArrayView subsystem;
+
+    // Fields are NUL separated; the first one is the "ACTION@DEVPATH" header
+    qsizetype pos = message.indexOf('\0');
+    while (pos >= 0 && pos < message.size()) {
+        const qsizetype start = pos + 1;
+        qsizetype end = message.indexOf('\0', start);
+        if (end < 0) {
+            end = message.size();
+        }
+
+        const QByteArrayView field(message.constData() + start, end - start);
+        if (field.startsWith("ACTION=")) {
+            actionValue = field.sliced(7);
+        } else if (field.startsWith("DEVPATH=")) {
+            devpath = field.sliced(8);
+        } else if (field.startsWith("SUBSYSTEM=")) {
+            subsystem = field.sliced(10);
+        }
+
+        pos = end;
+    }
+
+    if (subsystem != QByteArrayView("cpu")) {
+        return false;
+    }
+
+    // DEVPATH=/devices/system/cpu/cpuN
+    const qsizetype slash = devpath.lastIndexOf('/');
+    const QByteArrayView name = devpath.sliced(slash + 1);
+    if (!name.startsWith("cpu") || name.size() <= 3) {
+        return false;
+    }
+
+    bool ok = false;
+    const int number = name.sliced(3).toInt(&ok);
+    if (!ok) {
+        return false;
+    }
+
+    if (actionValue == QByteArrayView("online")) {
+        *action = CpuOnline;
+    } else if (actionValue == QByteArrayView("offline")) {
+        *action = CpuOffline;
+    } else if (actionValue == QByteArrayView("add")) {
+        *action = CpuAdded;
+    } else if (actionValue == QByteArrayView("remove")) {
+        *action = CpuRemoved;
+    } else {
+        return false;
+    }
+
+    *cpu = number;
+    return true;
+}
+
+void HotplugMonitor::onUevent(const QByteArray &message)
+{
+    int cpu = -1;
+    Action action = CpuOnline;
+
+    if (parseUevent(message, &cpu, &action)) {
+        qDebug() << "CPU hotplug event:" << cpu << action;
+        Q_EMIT cpuHotplugged(cpu, action);
+    }
+}
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef HOTPLUGMONITOR_H
+#define HOTPLUGMONITOR_H
+
+#include <QObject>
+#include <QByteArray>
+
+class UeventSource;
+
+/**
+ * @brief Reports CPU hotplug events from kernel uevents
+ *
+ * Listens to uevents of the "cpu" subsystem and emits the affected CPU
+ * number, so consumers can refresh just that CPU instead of rescanning
+ * /sys/devices/system/cpu.
+ */
+class HotplugMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Action {
+        CpuOnline,
+        CpuOffline,
+        CpuAdded,
+        CpuRemoved
+    };
+    Q_ENUM(Action)
+
+    // Uses the kernel netlink socket
+    explicit HotplugMonitor(QObject *parent = nullptr);
+    // Uses the given source (e.g. FakeUeventSource); takes ownership
+    explicit HotplugMonitor(UeventSource *source, QObject *parent = nullptr);
+    ~HotplugMonitor() override = default;
+
+    bool start();
+    bool isActive() const;
+
+    // Parse a raw uevent; returns false if it is not a CPU hotplug event
+    static bool parseUevent(const QByteArray &message, int *cpu, Action *action);
+
+signals:
+    void cpuHotplugged(int cpu, HotplugMonitor::Action action);
+    // Events were dropped (uevent queue overflow): rescan every CPU
+    void eventsLost();
+
+private slots:
+    void onUevent(const QByteArray &message);
+
+private:
+    UeventSource *m_source;
+};
+
+#endif // HOTPLUGMONITOR_H
@@ -0,0 +1,476 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "memorysysfsbackend.h"
+
+#include <QMutexLocker>
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+struct AttributeName {
+    const char *name;
+    quint8 attr;
+};
+
+// Writes into a caller buffer, silently truncating like a short read would
+struct Output {
+    char *buf;
+    qsizetype size;
+    qsizetype len = 0;
+
+    void append(const char *data, qsizetype n)
+    {
+        const qsizetype room = qMin(n, size - len);
+        if (room > 0) {
+            std::memcpy(buf + len, data, static_cast<size_t>(room));
+            len += room;
+        }
+    }
+
+    void append(const char *str) { append(str, static_cast<qsizetype>(std::strlen(str))); }
+    void append(char c) { append(&c, 1); }
+
+    void append(int value)
+    {
+        char tmp[16];
+        const int n = std::snprintf(tmp, sizeof(tmp), "%d", value);
+        append(tmp, n);
+    }
+
+    void append(const QString &str)
+    {
+        for (QChar c : str) {
+            append(static_cast<char>(c.toLatin1()));
+        }
+    }
+};
+
+bool parseNumber(QStringView text, int *value)
+{
+    if (text.isEmpty()) {
+        return false;
+    }
+    bool ok = false;
+    *value = text.toInt(&ok);
+    return ok && *value >= 0;
+}
+
+} // namespace
+
+MemorySysfsBackend::MemorySysfsBackend(const Config &config)
+    : m_config(config)
+{
+    m_cpuCount = qBound(1, m_config.cpuCount, MAX_CPUS);
+    m_config.cpusPerPolicy = qBound(1, m_config.cpusPerPolicy, m_cpuCount);
+    m_policyCount = (m_cpuCount + m_config.cpusPerPolicy - 1) / m_config.cpusPerPolicy;
+
+    if (m_config.governors.isEmpty()) {
+        m_config.governors.append(QStringLiteral("performance"));
+    }
+
+    Policy initial;
+    initial.scalingMin = m_config.hwMinFreq;
+    initial.scalingMax = m_config.hwMaxFreq;
+    initial.curFreq = m_config.hwMinFreq + (m_config.hwMaxFreq - m_config.hwMinFreq) / 2;
+    initial.governor = qMax(0, m_config.governors.indexOf(m_config.governor));
+    initial.energyPref = qMax(0, m_config.energyPrefs.indexOf(m_config.energyPref));
+
+    m_online.fill(true, m_cpuCount);
+    m_policies.fill(initial, m_policyCount);
+}
+
+// ============================================================================
+// Paths
+// ============================================================================
+
+MemorySysfsBackend::Node MemorySysfsBackend::parse(QStringView path) const
+{
+    static constexpr AttributeName globalNames[] = {
+        {"online", AttrOnline},
+        {"offline", AttrOffline},
+        {"present", AttrPresent},
+        {"possible", AttrPossible},
+    };
+    static constexpr AttributeName policyNames[] = {
+        {"scaling_cur_freq", AttrCurFreq},
+        {"scaling_min_freq", AttrScalingMin},
+        {"scaling_max_freq", AttrScalingMax},
+        {"cpuinfo_min_freq", AttrHwMin},
+        {"cpuinfo_max_freq", AttrHwMax},
+        {"scaling_governor", AttrGovernor},
+        {"scaling_available_governors", AttrAvailableGovernors},
+        {"scaling_available_frequencies", AttrAvailableFrequencies},
+        {"energy_performance_preference", AttrEnergyPref},
+        {"energy_performance_available_preferences", AttrAvailableEnergyPrefs},
+        {"affected_cpus", AttrAffectedCpus},
+        {"related_cpus", AttrRelatedCpus},
+    };
+
+    Node node;
+
+    const qsizetype slash = path.indexOf(QLatin1Char('/'));
+    if (slash < 0) {
+        for (const auto &entry : globalNames) {
+            if (path == QLatin1String(entry.name)) {
+                node.attr = static_cast<Attribute>(entry.attr);
+                return node;
+            }
+        }
+        return node;
+    }
+
+    const QStringView dir = path.first(slash);
+    QStringView rest = path.sliced(slash + 1);
+    int policy = -1;
+
+    if (dir.startsWith(QLatin1String("cpu")) && dir != QLatin1String("cpufreq")) {
+        // cpuN/online or cpuN/cpufreq/<attribute>
+        int cpu = -1;
+        if (!parseNumber(dir.sliced(3), &cpu) || cpu >= m_cpuCount) {
+            return node;
+        }
+
+        if (rest == QLatin1String("online")) {
+            node.attr = AttrCpuOnline;
+            node.index = cpu;
+            return node;
+        }
+        if (!rest.startsWith(QLatin1String("cpufreq/"))) {
+            return node;
+        }
+        rest = rest.sliced(8);
+        policy = policyOf(cpu);
+    } else if (dir == QLatin1String("cpufreq")) {
+        // cpufreq/policyN/<attribute>, named after the first CPU of the policy
+        const qsizetype next = rest.indexOf(QLatin1Char('/'));
+        if (next < 0 || !rest.startsWith(QLatin1String("policy"))) {
+            return node;
+        }
+        int firstCpu = -1;
+        if (!parseNumber(rest.first(next).sliced(6), &firstCpu) || firstCpu >= m_cpuCount
+            || firstCpu % m_config.cpusPerPolicy != 0) {
+            return node;
+        }
+        policy = policyOf(firstCpu);
+        rest = rest.sliced(next + 1);
+    } else {
+        return node;
+    }
+
+    for (const auto &entry : policyNames) {
+        if (rest == QLatin1String(entry.name)) {
+            node.attr = static_cast<Attribute>(entry.attr);
+            node.index = policy;
+            return node;
+        }
+    }
+
+    return node;
+}
+
+bool MemorySysfsBackend::nodeExists(const Node &node) const
+{
+    switch (node.attr) {
+    case AttrNone:
+        return false;
+    case AttrCpuOnline:
+        // CPU 0 cannot be hotplugged, so it has no online attribute
+        return node.index > 0;
+    case AttrAvailableFrequencies:
+        return !m_config.availableFrequencies.isEmpty();
+    case AttrEnergyPref:
+    case AttrAvailableEnergyPrefs:
+        return !m_config.energyPrefs.isEmpty();
+    default:
+        return true;
+    }
+}
+
+bool MemorySysfsBackend::policyActive(int policy) const
+{
+    const int first = policy * m_config.cpusPerPolicy;
+    const int last = qMin(first + m_config.cpusPerPolicy, m_cpuCount);
+    for (int cpu = first; cpu < last; ++cpu) {
+        if (m_online.at(cpu)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// SysfsBackend
+// ============================================================================
+
+int MemorySysfsBackend::open(const QString &path)
+{
+    const Node node = parse(path);
+
+    QMutexLocker locker(&m_mutex);
+    if (!nodeExists(node)) {
+        return -1;
+    }
+
+    const int handle = m_nextHandle++;
+    m_handles.insert(handle, node);
+    return handle;
+}
+
+qsizetype MemorySysfsBackend::readAt(int handle, char *buf, qsizetype size)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const auto it = m_handles.constFind(handle);
+    if (it == m_handles.constEnd()) {
+        return -1;
+    }
+    return render(it.value(), buf, size);
+}
+
+void MemorySysfsBackend::close(int handle)
+{
+    QMutexLocker locker(&m_mutex);
+    m_handles.remove(handle);
+}
+
+bool MemorySysfsBackend::exists(const QString &path) const
+{
+    const Node node = parse(path);
+
+    QMutexLocker locker(&m_mutex);
+    return nodeExists(node);
+}
+
+bool MemorySysfsBackend::write(const QString &path, const QByteArray &value)
+{
+    const Node node = parse(path);
+
+    QMutexLocker locker(&m_mutex);
+    if (!nodeExists(node) || !store(node, value.trimmed())) {
+        return false;
+    }
+
+    ++m_writeCount;
+    return true;
+}
+
+qsizetype MemorySysfsBackend::renderCpuRange(char *buf, qsizetype size, bool online, bool offline,
+                                             int first, int last) const
+{
+    Output out{buf, size};
+    bool separator = false;
+
+    int cpu = first;
+    while (cpu < last) {
+        const bool match = m_online.at(cpu) ? online : offline;
+        if (!match) {
+            ++cpu;
+            continue;
+        }
+
+        int end = cpu;
+        while (end + 1 < last && (m_online.at(end + 1) ? online : offline)) {
+            ++end;
+        }
+
+        if (separator) {
+            out.append(',');
+        }
+        out.append(cpu);
+        if (end > cpu) {
+            out.append('-');
+            out.append(end);
+        }
+        separator = true;
+        cpu = end + 1;
+    }
+
+    out.append('\n');
+    return out.len;
+}
+
+qsizetype MemorySysfsBackend::render(const Node &node, char *buf, qsizetype size) const
+{
+    Output out{buf, size};
+
+    switch (node.attr) {
+    case AttrOnline:
+        return renderCpuRange(buf, size, true, false, 0, m_cpuCount);
+    case AttrOffline:
+        return renderCpuRange(buf, size, false, true, 0, m_cpuCount);
+    case AttrPresent:
+    case AttrPossible:
+        return renderCpuRange(buf, size, true, true, 0, m_cpuCount);
+    case AttrCpuOnline:
+        out.append(m_online.at(node.index) ? '1' : '0');
+        out.append('\n');
+        return out.len;
+    default:
+        break;
+    }
+
+    // Policy attributes: the kernel refuses to show anything for a policy
+    // whose CPUs are all offline
+    if (node.index < 0 || !policyActive(node.index)) {
+        return -1;
+    }
+
+    const Policy &policy = m_policies.at(node.index);
+    const int first = node.index * m_config.cpusPerPolicy;
+    const int last = qMin(first + m_config.cpusPerPolicy, m_cpuCount);
+
+    switch (node.attr) {
+    case AttrCurFreq:
+        out.append(policy.curFreq);
+        break;
+    case AttrScalingMin:
+        out.append(policy.scalingMin);
+        break;
+    case AttrScalingMax:
+        out.append(policy.scalingMax);
+        break;
+    case AttrHwMin:
+        out.append(m_config.hwMinFreq);
+        break;
+    case AttrHwMax:
+        out.append(m_config.hwMaxFreq);
+        break;
+    case AttrGovernor:
+        out.append(m_config.governors.at(policy.governor));
+        break;
+    case AttrEnergyPref:
+        out.append(m_config.energyPrefs.at(policy.energyPref));
+        break;
+    case AttrAvailableGovernors:
+        for (const QString &governor : m_config.governors) {
+            out.append(governor);
+            out.append(' ');
+        }
+        break;
+    case AttrAvailableEnergyPrefs:
+        for (const QString &pref : m_config.energyPrefs) {
+            out.append(pref);
+            out.append(' ');
+        }
+        break;
+    case AttrAvailableFrequencies:
+        for (int freq : m_config.availableFrequencies) {
+            out.append(freq);
+            out.append(' ');
+        }
+        break;
+    case AttrAffectedCpus:
+    case AttrRelatedCpus:
+        // Space separated, online members only for affected_cpus
+        for (int cpu = first; cpu < last; ++cpu) {
+            if (node.attr == AttrRelatedCpus || m_online.at(cpu)) {
+                if (out.len > 0) {
+                    out.append(' ');
+                }
+                out.append(cpu);
+            }
+        }
+        break;
+    default:
+        return -1;
+    }
+
+    out.append('\n');
+    return out.len;
+}
+
+bool MemorySysfsBackend::store(const Node &node, const QByteArray &value)
+{
+    if (node.attr == AttrCpuOnline) {
+        if (value != "0" && value != "1") {
+            return false;
+        }
+        m_online[node.index] = value == "1";
+        return true;
+    }
+
+    if (node.index < 0 || !policyActive(node.index)) {
+        return false;
+    }
+
+    Policy &policy = m_policies[node.index];
+    const QString text = QString::fromLatin1(value);
+
+    switch (node.attr) {
+    case AttrScalingMin:
+    case AttrScalingMax: {
+        bool ok = false;
+        const int freq = value.toInt(&ok);
+        if (!ok || freq < m_config.hwMinFreq || freq > m_config.hwMaxFreq) {
+            return false;
+        }
+        if (node.attr == AttrScalingMin) {
+            if (freq > policy.scalingMax) {
+                return false;
+            }
+            policy.scalingMin = freq;
+        } else {
+            if (freq < policy.scalingMin) {
+                return false;
+            }
+            policy.scalingMax = freq;
+        }
+        policy.curFreq = qBound(policy.scalingMin, policy.curFreq, policy.scalingMax);
+        return true;
+    }
+    case AttrGovernor: {
+        const int index = m_config.governors.indexOf(text);
+        if (index < 0) {
+            return false;
+        }
+        policy.governor = index;
+        return true;
+    }
+    case AttrEnergyPref: {
+        const int index = m_config.energyPrefs.indexOf(text);
+        if (index < 0) {
+            return false;
+        }
+        policy.energyPref = index;
+        return true;
+    }
+    default:
+        // Everything else is read-only
+        return false;
+    }
+}
+
+// ============================================================================
+// Simulation controls
+// ============================================================================
+
+void MemorySysfsBackend::setCpuOnline(int cpu, bool online)
+{
+    QMutexLocker locker(&m_mutex);
+    if (cpu > 0 && cpu < m_cpuCount) {
+        m_online[cpu] = online;
+    }
+}
+
+void MemorySysfsBackend::setCurrentFrequency(int cpu, int freq)
+{
+    QMutexLocker locker(&m_mutex);
+    if (cpu >= 0 && cpu < m_cpuCount) {
+        m_policies[policyOf(cpu)].curFreq = freq;
+    }
+}
+
+int MemorySysfsBackend::writeCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_writeCount;
+}
+
+void MemorySysfsBackend::resetWriteCount()
+{
+    QMutexLocker locker(&m_mutex);
+    m_writeCount = 0;
+}
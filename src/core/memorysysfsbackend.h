@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef MEMORYSYSFSBACKEND_H
+#define MEMORYSYSFSBACKEND_H
+
+#include "sysfsbackend.h"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+
+/**
+ * @brief In-memory simulation of the CPU sysfs tree
+ *
+ * Models 1 to 4096 CPUs grouped into cpufreq policies, with the attributes
+ * cpupower-gui reads and writes. Writes are validated like the kernel does
+ * (unknown governor, min above max, offlining CPU 0 are rejected), and CPUs
+ * can be hotplugged with setCpuOnline(). Intended for tests and benchmarks.
+ */
+class MemorySysfsBackend : public SysfsBackend
+{
+public:
+    struct Config {
+        int cpuCount = 8;
+        int cpusPerPolicy = 1;
+        int hwMinFreq = 400000;         // kHz
+        int hwMaxFreq = 4800000;        // kHz
+        QStringList governors = {QStringLiteral("performance"), QStringLiteral("powersave")};
+        QString governor = QStringLiteral("powersave");
+        // Empty list disables energy_performance_preference
+        QStringList energyPrefs = {QStringLiteral("default"), QStringLiteral("performance"),
+                                   QStringLiteral("balance_performance"), QStringLiteral("balance_power"),
+                                   QStringLiteral("power")};
+        QString energyPref = QStringLiteral("balance_performance");
+        // Empty list omits scaling_available_frequencies (as intel_pstate does)
+        QList<int> availableFrequencies;
+    };
+
+    static constexpr int MAX_CPUS = 4096;
+
+    explicit MemorySysfsBackend(const Config &config = Config());
+    ~MemorySysfsBackend() override = default;
+
+    int open(const QString &path) override;
+    qsizetype readAt(int handle, char *buf, qsizetype size) override;
+    void close(int handle) override;
+
+    bool write(const QString &path, const QByteArray &value) override;
+    bool exists(const QString &path) const override;
+
+    // Simulation controls
+    int cpuCount() const { return m_cpuCount; }
+    void setCpuOnline(int cpu, bool online);
+    void setCurrentFrequency(int cpu, int freq);
+    int writeCount() const;
+    void resetWriteCount();
+
+private:
+    enum Attribute : quint8 {
+        AttrNone,
+        // Global
+        AttrOnline,
+        AttrOffline,
+        AttrPresent,
+        AttrPossible,
+        // Per CPU
+        AttrCpuOnline,
+        // Per policy
+        AttrCurFreq,
+        AttrScalingMin,
+        AttrScalingMax,
+        AttrHwMin,
+        AttrHwMax,
+        AttrGovernor,
+        AttrAvailableGovernors,
+        AttrAvailableFrequencies,
+        AttrEnergyPref,
+        AttrAvailableEnergyPrefs,
+        AttrAffectedCpus,
+        AttrRelatedCpus
+    };
+
+    struct Node {
+        Attribute attr = AttrNone;
+        int index = -1;         // CPU or policy number
+    };
+
+    struct Policy {
+        int curFreq = 0;
+        int scalingMin = 0;
+        int scalingMax = 0;
+        int governor = 0;       // Index into m_config.governors
+        int energyPref = 0;     // Index into m_config.energyPrefs
+    };
+
+    Node parse(QStringView path) const;
+    bool nodeExists(const Node &node) const;
+    qsizetype render(const Node &node, char *buf, qsizetype size) const;
+    bool store(const Node &node, const QByteArray &value);
+    bool policyActive(int policy) const;
+    int policyOf(int cpu) const { return cpu / m_config.cpusPerPolicy; }
+    qsizetype renderCpuRange(char *buf, qsizetype size, bool online, bool offline,
+                             int first, int last) const;
+
+    Config m_config;
+    int m_cpuCount;
+    int m_policyCount;
+
+    mutable QMutex m_mutex;
+    QList<bool> m_online;
+    QList<Policy> m_policies;
+    QHash<int, Node> m_handles;
+    int m_nextHandle = 0;
+    int m_writeCount = 0;
+};
+
+#endif // MEMORYSYSFSBACKEND_H
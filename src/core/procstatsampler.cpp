@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "procstatsampler.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Parses an unsigned decimal at @p p, skipping leading blanks; leaves @p p
+// after the digits. Returns false if there is no number before @p end.
+bool parseCounter(const char *&p, const char *end, quint64 &value)
+{
+    while (p < end && *p == ' ') {
+        ++p;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+        return false;
+    }
+
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + quint64(*p - '0');
+        ++p;
+    }
+    return true;
+}
+
+} // namespace
+
+ProcStatSampler::ProcStatSampler(const QString &path)
+    : m_path(path)
+{
+}
+
+ProcStatSampler::~ProcStatSampler()
+{
+    close();
+}
+
+void ProcStatSampler::setCpus(const QList<int> &cpus)
+{
+    int maxCpu = -1;
+    for (int cpu : cpus) {
+        maxCpu = std::max(maxCpu, cpu);
+    }
+
+    m_rowOfCpu.assign(size_t(maxCpu + 1), -1);
+    for (qsizetype row = 0; row < cpus.size(); ++row) {
+        if (cpus.at(row) >= 0) {
+            m_rowOfCpu[size_t(cpus.at(row))] = int(row);
+        }
+    }
+
+    m_counters.assign(size_t(cpus.size()), Counters());
+    m_busy.assign(size_t(cpus.size()), 0);
+    m_iowait.assign(size_t(cpus.size()), 0);
+    // Counters start at generation 0, so the first sample is never taken as
+    // one tick after it and only records a baseline instead of shares since boot
+    m_generation = 1;
+
+    // The aggregate line plus one per CPU; the interrupt lines after them
+    // are cut off by the read size and never looked at
+    m_buffer.resize((maxCpu + 2) * LINE_SIZE_LIMIT);
+}
+
+bool ProcStatSampler::sample()
+{
+    if (m_fd < 0) {
+        m_fd = ::open(QFile::encodeName(m_path).constData(), O_RDONLY | O_CLOEXEC);
+        if (m_fd < 0) {
+            return false;
+        }
+    }
+
+    // pread from 0 makes the kernel regenerate the file, like sysfs
+    ssize_t n;
+    do {
+        n = ::pread(m_fd, m_buffer.data(), size_t(m_buffer.size()), 0);
+    } while (n < 0 && errno == EINTR);
+
+    if (n <= 0) {
+        close();
+        return false;
+    }
+
+    parse(m_buffer.constData(), qsizetype(n));
+    return true;
+}
+
+void ProcStatSampler::parse(const char *data, qsizetype size)
+{
+    ++m_generation;
+    const char *p = data;
+    const char *const end = data + size;
+
+    // The cpu lines come first; stop at the first line that isn't one
+    while (end - p > 3 && std::memcmp(p, "cpu", 3) == 0) {
+        const char *eol = static_cast<const char *>(std::memchr(p, '\n', size_t(end - p)));
+        if (!eol) {
+            break;      // Cut off by the buffer
+        }
+        p += 3;
+
+        quint64 cpu = 0;
+        if (*p != ' ' && parseCounter(p, eol, cpu) && cpu < m_rowOfCpu.size()) {
+            const int row = m_rowOfCpu[size_t(cpu)];
+
+            // user nice system idle iowait irq softirq steal; guest time is
+            // already included in user and nice
+            quint64 fields[8] = {};
+            int count = 0;
+            while (count < 8 && parseCounter(p, eol, fields[count])) {
+                ++count;
+            }
+
+            if (row >= 0 && count >= 5) {
+                quint64 total = 0;
+                for (quint64 field : fields) {
+                    total += field;
+                }
+                const quint64 idle = fields[3];
+                const quint64 iowait = fields[4];
+
+                Counters &prev = m_counters[size_t(row)];
+                int busyShare = 0;
+                int iowaitShare = 0;
+                if (prev.generation + 1 == m_generation && total > prev.total) {
+                    const quint64 elapsed = total - prev.total;
+                    const quint64 busy = total - idle - iowait;
+                    busyShare = int((busy - std::min(busy, prev.busy)) * 1000 / elapsed);
+                    iowaitShare = int((iowait - std::min(iowait, prev.iowait)) * 1000 / elapsed);
+                }
+
+                prev.total = total;
+                prev.busy = total - idle - iowait;
+                prev.iowait = iowait;
+                prev.generation = m_generation;
+                m_busy[size_t(row)] = std::min(busyShare, 1000);
+                m_iowait[size_t(row)] = std::min(iowaitShare, 1000);
+            }
+        }
+
+        p = eol + 1;
+    }
+
+    // Offline CPUs have no line
+    for (size_t row = 0; row < m_counters.size(); ++row) {
+        if (m_counters[row].generation != m_generation) {
+            m_busy[row] = 0;
+            m_iowait[row] = 0;
+        }
+    }
+}
+
+void ProcStatSampler::close()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef PROCSTATSAMPLER_H
+#define PROCSTATSAMPLER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include <vector>
+
+/**
+ * @brief Per-CPU busy and iowait shares from /proc/stat
+ *
+ * Each sample() is a single read of the whole file into a buffer sized
+ * once in setCpus(), followed by an in-place parse of the "cpuN" lines;
+ * no memory is allocated per sample. Shares are the deltas since the
+ * previous sample, in per mille of the elapsed jiffies; the first sample
+ * after setCpus() only takes a baseline and reads 0. CPUs that are
+ * missing from the file (offline) read as 0 and restart their deltas
+ * when they come back.
+ *
+ * Not thread-safe; FrequencySampler drives it from its own thread.
+ */
+class ProcStatSampler
+{
+public:
+    explicit ProcStatSampler(const QString &path = QStringLiteral("/proc/stat"));
+    ~ProcStatSampler();
+
+    ProcStatSampler(const ProcStatSampler &) = delete;
+    ProcStatSampler &operator=(const ProcStatSampler &) = delete;
+
+    // CPUs to report, in row order
+    void setCpus(const QList<int> &cpus);
+
+    // Read and parse the file once; false if it could not be read
+    bool sample();
+    // Parse already read /proc/stat contents (sample() minus the read)
+    void parse(const char *data, qsizetype size);
+
+    int busyPermille(qsizetype row) const { return m_busy[row]; }
+    int iowaitPermille(qsizetype row) const { return m_iowait[row]; }
+
+private:
+    struct Counters {
+        quint64 total = 0;
+        quint64 busy = 0;
+        quint64 iowait = 0;
+        quint64 generation = 0;     // Sample this CPU was last seen in
+    };
+
+    void close();
+
+    QString m_path;
+    int m_fd = -1;
+    QByteArray m_buffer;
+    quint64 m_generation = 1;
+
+    std::vector<int> m_rowOfCpu;        // CPU number -> row, -1 if not reported
+    std::vector<Counters> m_counters;   // By row
+    std::vector<int> m_busy;            // By row, per mille
+    std::vector<int> m_iowait;
+
+    // "cpuNNNN" plus ten 20 digit counters, rounded up
+    static constexpr qsizetype LINE_SIZE_LIMIT = 256;
+};
+
+#endif // PROCSTATSAMPLER_H
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "sysfsbackend.h"
+#include "memorysysfsbackend.h"
+
+#include <QFile>
+#include <QDebug>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+qsizetype SysfsBackend::readOnce(const QString &path, char *buf, qsizetype size)
+{
+    const int handle = open(path);
+    if (handle < 0) {
+        return -1;
+    }
+
+    const qsizetype n = readAt(handle, buf, size - 1);
+    close(handle);
+
+    if (n >= 0) {
+        buf[n] = '\0';
+    }
+    return n;
+}
+
+QByteArray SysfsBackend::readAll(const QString &path)
+{
+    char buf[PAGE_SIZE_LIMIT + 1];
+    const qsizetype n = readOnce(path, buf, sizeof(buf));
+    if (n <= 0) {
+        return QByteArray();
+    }
+    return QByteArray(buf, n);
+}
+
+std::unique_ptr<SysfsBackend> SysfsBackend::create(const QString &root, int fakeCpus)
+{
+    if (fakeCpus > 0) {
+        MemorySysfsBackend::Config config;
+        config.cpuCount = fakeCpus;
+        qInfo() << "Using in-memory sysfs with" << fakeCpus << "CPUs";
+        return std::make_unique<MemorySysfsBackend>(config);
+    }
+
+    if (!root.isEmpty()) {
+        qInfo() << "Using sysfs root" << root;
+        return std::make_unique<RealSysfsBackend>(root);
+    }
+
+    return std::make_unique<RealSysfsBackend>();
+}
+
+// ============================================================================
+// RealSysfsBackend
+// ============================================================================
+
+RealSysfsBackend::RealSysfsBackend(const QString &root)
+    : m_root(root)
+{
+    while (m_root.size() > 1 && m_root.endsWith(QLatin1Char('/'))) {
+        m_root.chop(1);
+    }
+}
+
+QString RealSysfsBackend::defaultRoot()
+{
+    return QStringLiteral("/sys/devices/system/cpu");
+}
+
+QByteArray RealSysfsBackend::nativePath(const QString &path) const
+{
+    return QFile::encodeName(m_root + QLatin1Char('/') + path);
+}
+
+int RealSysfsBackend::open(const QString &path)
+{
+    return ::open(nativePath(path).constData(), O_RDONLY | O_CLOEXEC);
+}
+
+qsizetype RealSysfsBackend::readAt(int handle, char *buf, qsizetype size)
+{
+    ssize_t n;
+    do {
+        n = ::pread(handle, buf, static_cast<size_t>(size), 0);
+    } while (n < 0 && errno == EINTR);
+
+    return n;
+}
+
+void RealSysfsBackend::close(int handle)
+{
+    if (handle >= 0) {
+        ::close(handle);
+    }
+}
+
+bool RealSysfsBackend::write(const QString &path, const QByteArray &value)
+{
+    const QByteArray native = nativePath(path);
+    const int fd = ::open(native.constData(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        qWarning() << "Failed to open for writing:" << native << std::strerror(errno);
+        return false;
+    }
+
+    ssize_t n;
+    do {
+        n = ::write(fd, value.constData(), static_cast<size_t>(value.size()));
+    } while (n < 0 && errno == EINTR);
+
+    // sysfs reports rejected values (EINVAL, EBUSY) from write()
+    const int writeErrno = errno;
+    ::close(fd);
+
+    if (n < 0) {
+        qWarning() << "Failed to write" << value << "to" << native << std::strerror(writeErrno);
+        return false;
+    }
+    // errno is stale after a partial write
+    if (n != value.size()) {
+        qWarning() << "Short write of" << value << "to" << native << "(" << n << "of" << value.size() << "bytes)";
+        return false;
+    }
+
+    return true;
+}
+
+bool RealSysfsBackend::exists(const QString &path) const
+{
+    struct stat st;
+    return ::stat(nativePath(path).constData(), &st) == 0;
+}
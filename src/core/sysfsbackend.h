@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef SYSFSBACKEND_H
+#define SYSFSBACKEND_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <memory>
+
+/**
+ * @brief Storage behind the CPU sysfs tree
+ *
+ * All paths are relative to the CPU root (/sys/devices/system/cpu on a real
+ * system), e.g. "online" or "cpu3/cpufreq/scaling_governor".
+ *
+ * Reads go through handles so callers can keep frequently read attributes
+ * open and re-read them from offset 0, which is how sysfs regenerates an
+ * attribute's contents. Implementations must be safe to use from several
+ * threads at once.
+ */
+class SysfsBackend
+{
+public:
+    virtual ~SysfsBackend() = default;
+
+    // Returns a handle >= 0, or -1 if the attribute does not exist / cannot be opened
+    virtual int open(const QString &path) = 0;
+    // Read the whole attribute from offset 0; returns bytes read or -1 on error
+    virtual qsizetype readAt(int handle, char *buf, qsizetype size) = 0;
+    virtual void close(int handle) = 0;
+
+    virtual bool write(const QString &path, const QByteArray &value) = 0;
+    virtual bool exists(const QString &path) const = 0;
+
+    // One-shot read into a caller buffer; the result is NUL terminated
+    qsizetype readOnce(const QString &path, char *buf, qsizetype size);
+    // One-shot read of a complete attribute (at most a page, like sysfs)
+    QByteArray readAll(const QString &path);
+
+    // Real sysfs under @p root, or an in-memory machine when @p fakeCpus > 0
+    static std::unique_ptr<SysfsBackend> create(const QString &root = QString(), int fakeCpus = 0);
+
+    static constexpr qsizetype PAGE_SIZE_LIMIT = 4096;
+};
+
+/**
+ * @brief SysfsBackend on the real file system
+ *
+ * The root is configurable so a copied or generated sysfs tree can be used.
+ */
+class RealSysfsBackend : public SysfsBackend
+{
+public:
+    explicit RealSysfsBackend(const QString &root = defaultRoot());
+
+    static QString defaultRoot();
+    QString root() const { return m_root; }
+
+    int open(const QString &path) override;
+    qsizetype readAt(int handle, char *buf, qsizetype size) override;
+    void close(int handle) override;
+
+    bool write(const QString &path, const QByteArray &value) override;
+    bool exists(const QString &path) const override;
+
+private:
+    QByteArray nativePath(const QString &path) const;
+
+    QString m_root;
+};
+
+#endif // SYSFSBACKEND_H
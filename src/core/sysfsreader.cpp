@@ -2,30 +2,163 @@
 // SPDX-FileCopyrightText: 2024 cpupower-gui contributors
 
 #include "sysfsreader.h"
+#include "sysfsbackend.h"
 
-#include <QFile>
-#include <QTextStream>
-#include <QDir>
 #include <QDebug>
 #include <QRegularExpression>
 
-SysfsReader::SysfsReader(QObject *parent)
+#include <cctype>
+#include <cstdlib>
+
+SysfsReader::SysfsReader(SysfsBackend *backend, QObject *parent)
     : QObject(parent)
+    , m_backend(backend)
 {
 }
 
-QString SysfsReader::readFile(const QString &path) const
+SysfsReader::~SysfsReader()
 {
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return QString();
+    invalidateDescriptors();
+}
+
+void SysfsReader::setFdBudget(int budget)
+{
+    m_fdBudget = qMax(0, budget);
+
+    // Shrinking below the current usage is simplest handled by starting over
+    if (m_openFds > m_fdBudget) {
+        invalidateDescriptors();
+    }
+}
+
+void SysfsReader::invalidateDescriptors()
+{
+    for (auto &fds : m_cpuFds) {
+        for (int &fd : fds) {
+            closeDescriptor(fd);
+        }
+    }
+    m_cpuFds.clear();
+
+    for (int &fd : m_systemFds) {
+        closeDescriptor(fd);
+    }
+
+    // The set of available CPUs may have changed as well
+    m_snapshotLayoutValid = false;
+}
+
+void SysfsReader::invalidateDescriptors(int cpu)
+{
+    if (cpu < 0 || cpu >= m_cpuFds.size()) {
+        return;
+    }
+
+    for (int &fd : m_cpuFds[cpu]) {
+        closeDescriptor(fd);
+    }
+}
+
+void SysfsReader::closeDescriptor(int &fd) const
+{
+    if (fd >= 0) {
+        m_backend->close(fd);
+        fd = -1;
+        --m_openFds;
+    }
+}
+
+qsizetype SysfsReader::readDescriptor(int &fd, const QString &path, char *buf, qsizetype size) const
+{
+    if (fd < 0) {
+        const int newFd = m_backend->open(path);
+        if (newFd < 0) {
+            return -1;
+        }
+
+        if (m_openFds >= m_fdBudget) {
+            // Over budget: behave like a plain one-shot read
+            const qsizetype n = m_backend->readAt(newFd, buf, size - 1);
+            m_backend->close(newFd);
+            return n;
+        }
+
+        fd = newFd;
+        ++m_openFds;
+    }
+
+    // sysfs regenerates the attribute contents on every read from offset 0
+    const qsizetype n = m_backend->readAt(fd, buf, size - 1);
+
+    if (n < 0) {
+        // The attribute went away (CPU unplugged, policy torn down); reopen next time
+        closeDescriptor(fd);
+        return -1;
+    }
+
+    return n;
+}
+
+qsizetype SysfsReader::readHot(int cpu, HotAttribute attr, char *buf, qsizetype size) const
+{
+    static constexpr const char *names[HotAttributeCount] = {SCALING_CUR_FREQ, SCALING_GOVERNOR};
+
+    if (cpu < 0) {
+        return -1;
+    }
+
+    if (cpu >= m_cpuFds.size()) {
+        std::array<int, HotAttributeCount> closed;
+        closed.fill(-1);
+        m_cpuFds.resize(cpu + 1, closed);
     }
 
-    QTextStream stream(&file);
-    return stream.readAll().trimmed();
+    int &fd = m_cpuFds[cpu][attr];
+    const QString path = fd < 0
+        ? QStringLiteral("%1/%2").arg(cpuPath(cpu), QLatin1String(names[attr]))
+        : QString();
+
+    const qsizetype n = readDescriptor(fd, path, buf, size);
+    if (n >= 0) {
+        buf[n] = '\0';
+    }
+    return n;
+}
+
+qsizetype SysfsReader::readSystemFile(SystemFile file, char *buf, qsizetype size) const
+{
+    static constexpr const char *names[SystemFileCount] = {ONLINE_FILE, PRESENT_FILE};
+
+    int &fd = m_systemFds[file];
+    const QString path = fd < 0 ? QString::fromLatin1(names[file]) : QString();
+
+    const qsizetype n = readDescriptor(fd, path, buf, size);
+    if (n >= 0) {
+        buf[n] = '\0';
+    }
+    return n;
 }
 
-QStringList SysfsReader::parseList(const QString &content) const
+qsizetype SysfsReader::readOnce(const QString &path, char *buf, qsizetype size) const
+{
+    return m_backend->readOnce(path, buf, size);
+}
+
+int SysfsReader::readIntFile(const QString &path) const
+{
+    char buf[HOT_BUFFER_SIZE];
+    if (readOnce(path, buf, sizeof(buf)) <= 0) {
+        return 0;
+    }
+    return static_cast<int>(std::strtol(buf, nullptr, 10));
+}
+
+QString SysfsReader::readFile(const QString &path) const
+{
+    return QString::fromLatin1(m_backend->readAll(path)).trimmed();
+}
+
+QStringList SysfsReader::parseList(const QString &content)
 {
     if (content.isEmpty()) {
         return QStringList();
@@ -34,7 +167,7 @@ QStringList SysfsReader::parseList(const QString &content) const
     return content.split(QRegularExpression(QStringLiteral("\\s+")), Qt::SkipEmptyParts);
 }
 
-QList<int> SysfsReader::parseCpuList(const QString &content) const
+QList<int> SysfsReader::parseCpuList(const QString &content)
 {
     QList<int> result;
     if (content.isEmpty()) {
@@ -63,10 +196,7 @@ QList<int> SysfsReader::parseCpuList(const QString &content) const
 
 QString SysfsReader::cpuPath(int cpu) const
 {
-    return QStringLiteral("%1/cpu%2/%3")
-        .arg(QLatin1String(SYS_CPU_PATH))
-        .arg(cpu)
-        .arg(QLatin1String(CPUFREQ_PATH));
+    return QStringLiteral("cpu%1/%2").arg(cpu).arg(QLatin1String(CPUFREQ_PATH));
 }
 
 int SysfsReader::currentFreq(int cpu) const
@@ -75,14 +205,12 @@ int SysfsReader::currentFreq(int cpu) const
         return 0;
     }
 
-    const QString path = QStringLiteral("%1/%2").arg(cpuPath(cpu), QLatin1String(SCALING_CUR_FREQ));
-    const QString content = readFile(path);
-
-    if (content.isEmpty()) {
+    char buf[HOT_BUFFER_SIZE];
+    if (readHot(cpu, HotCurFreq, buf, sizeof(buf)) <= 0) {
         return 0;
     }
 
-    return content.toInt();
+    return static_cast<int>(std::strtol(buf, nullptr, 10));
 }
 
 QPair<int, int> SysfsReader::freqLimits(int cpu) const
@@ -141,8 +269,9 @@ QString SysfsReader::currentGovernor(int cpu) const
         return QStringLiteral("OFFLINE");
     }
 
-    const QString path = QStringLiteral("%1/%2").arg(cpuPath(cpu), QLatin1String(SCALING_GOVERNOR));
-    QString governor = readFile(path);
+    char buf[HOT_BUFFER_SIZE];
+    const qsizetype n = readHot(cpu, HotGovernor, buf, sizeof(buf));
+    const QString governor = n > 0 ? QString::fromLatin1(buf, n).trimmed() : QString();
 
     if (governor.isEmpty()) {
         return QStringLiteral("ERROR");
@@ -172,27 +301,63 @@ QString SysfsReader::currentEnergyPref(int cpu) const
 bool SysfsReader::isEnergyPrefAvailable(int cpu) const
 {
     const QString path = QStringLiteral("%1/%2").arg(cpuPath(cpu), QLatin1String(ENERGY_PERF_AVAIL));
-    return QFile::exists(path);
+    return m_backend->exists(path);
 }
 
 bool SysfsReader::isOnline(int cpu) const
 {
-    const QList<int> online = onlineCpus();
-    const QList<int> present = presentCpus();
+    ensureCpuMasks();
+    return m_presentMask.test(cpu) && m_onlineMask.test(cpu);
+}
 
-    return present.contains(cpu) && online.contains(cpu);
+bool SysfsReader::cpuAllowedOffline(int cpu) const
+{
+    // Same check as the helper's cpu_allowed_offline, without the round-trip
+    return m_backend->exists(QStringLiteral("cpu%1/%2").arg(cpu).arg(QLatin1String(ONLINE_FILE)));
 }
 
 QList<int> SysfsReader::onlineCpus() const
 {
-    const QString path = QStringLiteral("%1/%2").arg(QLatin1String(SYS_CPU_PATH), QLatin1String(ONLINE_FILE));
-    return parseCpuList(readFile(path));
+    ensureCpuMasks();
+    return m_onlineMask.toList();
 }
 
 QList<int> SysfsReader::presentCpus() const
 {
-    const QString path = QStringLiteral("%1/%2").arg(QLatin1String(SYS_CPU_PATH), QLatin1String(PRESENT_FILE));
-    return parseCpuList(readFile(path));
+    ensureCpuMasks();
+    return m_presentMask.toList();
+}
+
+void SysfsReader::refreshCpuMasks()
+{
+    char buf[CPU_LIST_BUFFER_SIZE];
+
+    qsizetype n = readSystemFile(SystemOnline, buf, sizeof(buf));
+    m_onlineMask = CpuMask::fromCpuList(buf, qMax<qsizetype>(n, 0));
+
+    n = readSystemFile(SystemPresent, buf, sizeof(buf));
+    m_presentMask = CpuMask::fromCpuList(buf, qMax<qsizetype>(n, 0));
+
+    ++m_maskGeneration;
+}
+
+void SysfsReader::ensureCpuMasks() const
+{
+    if (m_maskGeneration == 0) {
+        const_cast<SysfsReader *>(this)->refreshCpuMasks();
+    }
+}
+
+const CpuMask &SysfsReader::onlineMask() const
+{
+    ensureCpuMasks();
+    return m_onlineMask;
+}
+
+const CpuMask &SysfsReader::presentMask() const
+{
+    ensureCpuMasks();
+    return m_presentMask;
 }
 
 QList<int> SysfsReader::availableCpus() const
@@ -206,7 +371,7 @@ QList<int> SysfsReader::availableCpus() const
         const QString maxPath = QStringLiteral("%1/%2").arg(basePath, QLatin1String(CPUINFO_MAX_FREQ));
         const QString govPath = QStringLiteral("%1/%2").arg(basePath, QLatin1String(SCALING_AVAILABLE_GOV));
 
-        if (QFile::exists(minPath) && QFile::exists(maxPath) && QFile::exists(govPath)) {
+        if (m_backend->exists(minPath) && m_backend->exists(maxPath) && m_backend->exists(govPath)) {
             result.append(cpu);
         }
     }
@@ -233,3 +398,215 @@ qint64 SysfsReader::maxFrequencyHardware(int cpu) const
 {
     return freqLimits(cpu).second;
 }
+
+// ============================================================================
+// Snapshots
+// ============================================================================
+
+int SysfsReader::internString(const char *data, qsizetype size)
+{
+    while (size > 0 && std::isspace(static_cast<unsigned char>(data[size - 1]))) {
+        --size;
+    }
+    while (size > 0 && std::isspace(static_cast<unsigned char>(*data))) {
+        ++data;
+        --size;
+    }
+
+    // fromRawData() does not copy, so lookups of already known strings are free
+    const int id = m_stringIds.value(QByteArray::fromRawData(data, size), -1);
+    if (id >= 0) {
+        return id;
+    }
+
+    const QByteArray key(data, size);
+    m_strings.append(QString::fromLatin1(key));
+    m_stringIds.insert(key, m_strings.size() - 1);
+    return m_strings.size() - 1;
+}
+
+QString SysfsReader::internedString(int id) const
+{
+    if (id < 0 || id >= m_strings.size()) {
+        return QString();
+    }
+    return m_strings.at(id);
+}
+
+void SysfsReader::rebuildSnapshotLayout()
+{
+    const QList<int> cpus = availableCpus();
+
+    int maxCpu = -1;
+    for (int cpu : cpus) {
+        maxCpu = qMax(maxCpu, cpu);
+    }
+
+    m_snapshots.clear();
+    m_snapshotPrefixes.clear();
+    m_snapshots.reserve(cpus.size());
+    m_snapshotPrefixes.reserve(cpus.size());
+    m_snapshotRows.fill(-1, maxCpu + 1);
+    m_sharedPolicies = false;
+
+    CpuMask seenPolicies;
+    for (int cpu : cpus) {
+        m_snapshotRows[cpu] = m_snapshots.size();
+
+        CpuSnapshot snap;
+        snap.cpu = cpu;
+        m_snapshotPrefixes.append(cpuPath(cpu) + QLatin1Char('/'));
+        snap.policy = readPolicy(cpu, m_snapshotPrefixes.last());
+        m_snapshots.append(snap);
+
+        if (seenPolicies.test(snap.policy)) {
+            m_sharedPolicies = true;
+        }
+        seenPolicies.set(snap.policy);
+    }
+
+    m_snapshotLayoutValid = true;
+}
+
+int SysfsReader::readPolicy(int cpu, const QString &prefix) const
+{
+    char buf[CPU_LIST_BUFFER_SIZE];
+
+    // related_cpus also lists offline members; affected_cpus is the fallback for
+    // drivers without it. The kernel names policyN after its first CPU.
+    qsizetype n = readOnce(prefix + QLatin1String(RELATED_CPUS), buf, sizeof(buf));
+    if (n <= 0) {
+        n = readOnce(prefix + QLatin1String(AFFECTED_CPUS), buf, sizeof(buf));
+    }
+
+    const int policy = n > 0 ? CpuMask::fromCpuList(buf, n).first() : -1;
+    return policy >= 0 ? policy : cpu;
+}
+
+int SysfsReader::policyOf(int cpu) const
+{
+    const CpuSnapshot *snap = lastSnapshot(cpu);
+    return snap ? snap->policy : -1;
+}
+
+QList<int> SysfsReader::policyCpus(int policy) const
+{
+    QList<int> result;
+    for (const CpuSnapshot &snap : m_snapshots) {
+        if (snap.policy == policy) {
+            result.append(snap.cpu);
+        }
+    }
+    return result;
+}
+
+void SysfsReader::fillSnapshot(CpuSnapshot &snap, const QString &prefix, bool present, bool online, bool refreshStatic)
+{
+    char buf[HOT_BUFFER_SIZE];
+
+    if (!present) {
+        snap.state = CpuSnapshot::NotPresent;
+    } else {
+        snap.state = online ? CpuSnapshot::Online : CpuSnapshot::Offline;
+    }
+
+    // Hardware limits and EPP support do not change at runtime
+    if (refreshStatic) {
+        snap.hwMin = readIntFile(prefix + QLatin1String(CPUINFO_MIN_FREQ));
+        snap.hwMax = readIntFile(prefix + QLatin1String(CPUINFO_MAX_FREQ));
+        snap.energyPrefAvailable = m_backend->exists(prefix + QLatin1String(ENERGY_PERF_AVAIL));
+    }
+
+    if (snap.online()) {
+        snap.curFreq = readHot(snap.cpu, HotCurFreq, buf, sizeof(buf)) > 0
+            ? static_cast<int>(std::strtol(buf, nullptr, 10))
+            : 0;
+        snap.scalingMin = readIntFile(prefix + QLatin1String(SCALING_MIN_FREQ));
+        snap.scalingMax = readIntFile(prefix + QLatin1String(SCALING_MAX_FREQ));
+
+        const qsizetype n = readHot(snap.cpu, HotGovernor, buf, sizeof(buf));
+        snap.governorId = n > 0 ? internString(buf, n) : -1;
+        if (snap.governorId < 0 || m_strings.at(snap.governorId).isEmpty()) {
+            snap.governorId = internString("ERROR", 5);
+        }
+    } else {
+        snap.curFreq = 0;
+        snap.scalingMin = 0;
+        snap.scalingMax = 0;
+        snap.governorId = internString("OFFLINE", 7);
+    }
+
+    snap.energyPrefId = -1;
+    if (snap.energyPrefAvailable) {
+        const qsizetype n = readOnce(prefix + QLatin1String(ENERGY_PERF_PREF), buf, sizeof(buf));
+        if (n > 0) {
+            snap.energyPrefId = internString(buf, n);
+        }
+    }
+}
+
+const QList<CpuSnapshot> &SysfsReader::snapshotAll()
+{
+    const bool refreshStatic = !m_snapshotLayoutValid;
+    if (refreshStatic) {
+        rebuildSnapshotLayout();
+    }
+
+    // One read of each mask per pass instead of one per attribute
+    refreshCpuMasks();
+
+    for (qsizetype row = 0; row < m_snapshots.size(); ++row) {
+        CpuSnapshot &snap = m_snapshots[row];
+        const bool present = m_presentMask.test(snap.cpu);
+        fillSnapshot(snap, m_snapshotPrefixes.at(row), present, present && m_onlineMask.test(snap.cpu), refreshStatic);
+    }
+
+    return m_snapshots;
+}
+
+CpuSnapshot SysfsReader::snapshot(int cpu)
+{
+    if (!m_snapshotLayoutValid) {
+        // The layout (and the static fields of every row) has to be rebuilt anyway
+        snapshotAll();
+        const CpuSnapshot *snap = lastSnapshot(cpu);
+        if (snap) {
+            return *snap;
+        }
+    }
+
+    if (cpu < 0 || cpu >= m_snapshotRows.size() || m_snapshotRows.at(cpu) < 0) {
+        CpuSnapshot missing;
+        missing.cpu = cpu;
+        return missing;
+    }
+
+    refreshCpuMasks();
+
+    const int row = m_snapshotRows.at(cpu);
+    CpuSnapshot &snap = m_snapshots[row];
+    const bool present = m_presentMask.test(cpu);
+    fillSnapshot(snap, m_snapshotPrefixes.at(row), present, present && m_onlineMask.test(cpu), false);
+    return snap;
+}
+
+const QList<CpuSnapshot> &SysfsReader::snapshots()
+{
+    if (!m_snapshotLayoutValid) {
+        return snapshotAll();
+    }
+    return m_snapshots;
+}
+
+const CpuSnapshot *SysfsReader::lastSnapshot(int cpu) const
+{
+    if (cpu < 0 || cpu >= m_snapshotRows.size()) {
+        return nullptr;
+    }
+
+    const int row = m_snapshotRows.at(cpu);
+    if (row < 0 || row >= m_snapshots.size()) {
+        return nullptr;
+    }
+    return &m_snapshots.at(row);
+}
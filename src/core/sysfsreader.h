@@ -9,20 +9,58 @@
 #include <QStringList>
 #include <QPair>
 #include <QList>
+#include <QHash>
+#include <QByteArray>
+
+#include <array>
+
+#include "cpumask.h"
+
+class SysfsBackend;
+
+/**
+ * @brief Flat per-CPU state captured by SysfsReader in a single sysfs pass
+ *
+ * Frequencies are in kHz. Governor and energy preference are ids interned in
+ * the SysfsReader that produced the snapshot (see SysfsReader::internedString()),
+ * so copying or comparing snapshots never touches string data.
+ */
+struct CpuSnapshot {
+    enum State : quint8 {
+        NotPresent = 0,
+        Offline,
+        Online
+    };
+
+    int cpu = -1;
+    int curFreq = 0;
+    int scalingMin = 0;
+    int scalingMax = 0;
+    int hwMin = 0;
+    int hwMax = 0;
+    int governorId = -1;
+    int energyPrefId = -1;
+    int policy = -1;            // cpufreq policy, numbered like its policyN directory
+    State state = NotPresent;
+    bool energyPrefAvailable = false;
+
+    bool online() const { return state == Online; }
+};
 
 /**
  * @brief Direct sysfs reader for CPU information
  * 
  * This class reads CPU information directly from /sys/devices/system/cpu/
  * for non-privileged operations (reading current frequencies, governors, etc.)
+ * All access goes through the given SysfsBackend, which must outlive the reader.
  */
 class SysfsReader : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit SysfsReader(QObject *parent = nullptr);
-    ~SysfsReader() override = default;
+    explicit SysfsReader(SysfsBackend *backend, QObject *parent = nullptr);
+    ~SysfsReader() override;
 
     // Frequency info (in kHz)
     Q_INVOKABLE int currentFreq(int cpu) const;
@@ -43,20 +81,77 @@ public:
     Q_INVOKABLE QString currentEnergyPref(int cpu) const;
     Q_INVOKABLE bool isEnergyPrefAvailable(int cpu) const;
 
-    // Online state
+    // Online state (answered from the cached masks, see refreshCpuMasks())
     Q_INVOKABLE bool isOnline(int cpu) const;
+    // Hotpluggable CPUs have cpuN/online; the boot CPU usually does not
+    Q_INVOKABLE bool cpuAllowedOffline(int cpu) const;
     Q_INVOKABLE QList<int> onlineCpus() const;
     Q_INVOKABLE QList<int> presentCpus() const;
     Q_INVOKABLE QList<int> availableCpus() const;
 
+    // Re-read online/present once (per monitor tick or hotplug event). Every
+    // refresh bumps the generation so callers can tell whether masks moved on.
+    void refreshCpuMasks();
+    quint64 maskGeneration() const { return m_maskGeneration; }
+    const CpuMask &onlineMask() const;
+    const CpuMask &presentMask() const;
+
+    // Single-pass snapshot of all available CPUs. online/present are read once per pass.
+    const QList<CpuSnapshot> &snapshotAll();
+    // Refresh and return the snapshot of a single CPU
+    CpuSnapshot snapshot(int cpu);
+    // Last snapshot taken (takes one first if none exists yet)
+    const QList<CpuSnapshot> &snapshots();
+    // Entry of the last snapshot for a CPU, nullptr if the CPU is not available
+    const CpuSnapshot *lastSnapshot(int cpu) const;
+    QString internedString(int id) const;
+
+    // cpufreq policy topology, discovered with the snapshot layout. CPUs of one
+    // policy share scaling_* attributes, so writing one of them is enough.
+    int policyOf(int cpu) const;
+    QList<int> policyCpus(int policy) const;
+    bool hasSharedPolicies() const { return m_sharedPolicies; }
+
+    // Descriptor cache for hot attributes (scaling_cur_freq, scaling_governor, online)
+    int fdBudget() const { return m_fdBudget; }
+    void setFdBudget(int budget);
+    int openDescriptorCount() const { return m_openFds; }
+    void invalidateDescriptors();           // Drop all cached descriptors and the CPU list (e.g. after hotplug)
+    void invalidateDescriptors(int cpu);    // Drop cached descriptors of a single CPU
+
+    // Parsers for sysfs list attributes ("performance powersave", "0,2,4-10")
+    static QStringList parseList(const QString &content);
+    static QList<int> parseCpuList(const QString &content);
+
 private:
+    enum HotAttribute {
+        HotCurFreq = 0,
+        HotGovernor,
+        HotAttributeCount
+    };
+
+    enum SystemFile {
+        SystemOnline = 0,
+        SystemPresent,
+        SystemFileCount
+    };
+
     QString readFile(const QString &path) const;
-    QStringList parseList(const QString &content) const;
-    QList<int> parseCpuList(const QString &content) const;
+    int readIntFile(const QString &path) const;
+    qsizetype readHot(int cpu, HotAttribute attr, char *buf, qsizetype size) const;
+    qsizetype readSystemFile(SystemFile file, char *buf, qsizetype size) const;
+    qsizetype readDescriptor(int &fd, const QString &path, char *buf, qsizetype size) const;
+    void closeDescriptor(int &fd) const;
 
     QString cpuPath(int cpu) const;
 
-    static constexpr const char *SYS_CPU_PATH = "/sys/devices/system/cpu";
+    void ensureCpuMasks() const;
+    qsizetype readOnce(const QString &path, char *buf, qsizetype size) const;
+    void fillSnapshot(CpuSnapshot &snap, const QString &prefix, bool present, bool online, bool refreshStatic);
+    int internString(const char *data, qsizetype size);
+    void rebuildSnapshotLayout();
+    int readPolicy(int cpu, const QString &prefix) const;
+
     static constexpr const char *CPUFREQ_PATH = "cpufreq";
     static constexpr const char *SCALING_CUR_FREQ = "scaling_cur_freq";
     static constexpr const char *SCALING_MIN_FREQ = "scaling_min_freq";
@@ -70,6 +165,38 @@ private:
     static constexpr const char *ENERGY_PERF_PREF = "energy_performance_preference";
     static constexpr const char *ONLINE_FILE = "online";
     static constexpr const char *PRESENT_FILE = "present";
+    static constexpr const char *RELATED_CPUS = "related_cpus";
+    static constexpr const char *AFFECTED_CPUS = "affected_cpus";
+
+    // Small enough for any single-value attribute; list attributes go through readFile()
+    static constexpr qsizetype HOT_BUFFER_SIZE = 128;
+    static constexpr qsizetype CPU_LIST_BUFFER_SIZE = 4096;   // sysfs attributes never exceed a page
+    static constexpr int DEFAULT_FD_BUDGET = 512;
+
+    SysfsBackend *m_backend;
+
+    // Cached backend handles, -1 when not open. Mutable because reads are logically const.
+    mutable QList<std::array<int, HotAttributeCount>> m_cpuFds;
+    mutable std::array<int, SystemFileCount> m_systemFds{{-1, -1}};
+    mutable int m_openFds = 0;
+    int m_fdBudget = DEFAULT_FD_BUDGET;
+
+    // Cached online/present masks; generation 0 means never loaded
+    mutable CpuMask m_onlineMask;
+    mutable CpuMask m_presentMask;
+    mutable quint64 m_maskGeneration = 0;
+
+    // Snapshot storage: rows in availableCpus() order, cpu -> row lookup, and
+    // "<cpu path>/" prefixes so a sweep does no path formatting
+    QList<CpuSnapshot> m_snapshots;
+    QList<int> m_snapshotRows;
+    QList<QString> m_snapshotPrefixes;
+    bool m_snapshotLayoutValid = false;
+    bool m_sharedPolicies = false;
+
+    // Interned governor / energy preference strings
+    QList<QString> m_strings;
+    QHash<QByteArray, int> m_stringIds;
 };
 
 #endif // SYSFSREADER_H
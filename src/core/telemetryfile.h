@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef TELEMETRYFILE_H
+#define TELEMETRYFILE_H
+
+#include <QDir>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief On-disk layout shared by TelemetryRecorder and TelemetryReader
+ *
+ * A telemetry file is preallocated to its final size and used as a ring:
+ *
+ *   TelemetryFileHeader             512 bytes
+ *   quint32 cpus[cpuCount]          CPU number of each lane
+ *   (padding to dataOffset)
+ *   records[capacity]               recordSize bytes each
+ *
+ * A record is two qint64 timestamps followed by one TelemetryCpuRecord per
+ * lane: the wall clock (ms since the epoch) as it read when sampling, and a
+ * steady timestamp on the same scale that never goes back. The steady one is
+ * CLOCK_BOOTTIME anchored to the wall clock when recording starts, so wall
+ * clock steps (NTP, manual changes) cannot unsort the ring; records are
+ * searched by it. Record i of the history lives in slot
+ * (written - count + i) % capacity, where count = min(written, capacity).
+ * All integers are in host byte order; the file is not meant to be moved
+ * between machines.
+ */
+
+namespace TelemetryFile {
+
+constexpr char MAGIC[8] = {'C', 'P', 'G', 'T', 'E', 'L', 'M', '\0'};
+constexpr quint32 VERSION = 2;
+constexpr int MAX_GOVERNORS = 28;
+constexpr int GOVERNOR_NAME_SIZE = 16;      // Including the terminating NUL
+constexpr quint8 NO_GOVERNOR = 0xff;
+constexpr quint8 FLAG_ONLINE = 0x1;
+
+// Wall clock and steady timestamps in front of the lanes of each record
+constexpr quint32 RECORD_PREFIX_SIZE = 2 * sizeof(qint64);
+constexpr quint32 STEADY_OFFSET = sizeof(qint64);
+
+// ~/.local/state/cpupower_gui/telemetry.bin (honours XDG_STATE_HOME)
+inline QString defaultPath()
+{
+    const QString stateHome = qEnvironmentVariable("XDG_STATE_HOME",
+                                                   QDir::homePath() + QStringLiteral("/.local/state"));
+    return stateHome + QStringLiteral("/cpupower_gui/telemetry.bin");
+}
+
+} // namespace TelemetryFile
+
+struct TelemetryFileHeader {
+    char magic[8];
+    quint32 version;
+    quint32 headerSize;         // sizeof(TelemetryFileHeader)
+    quint32 cpuCount;           // Lanes per record
+    quint32 intervalMs;         // Nominal interval of the run that created the file
+    quint32 recordSize;
+    quint32 governorCount;
+    quint64 capacity;           // Records the file can hold
+    quint64 written;            // Records ever appended
+    quint64 dataOffset;         // Offset of record slot 0
+    qint64 createdMs;
+    char governors[TelemetryFile::MAX_GOVERNORS][TelemetryFile::GOVERNOR_NAME_SIZE];
+};
+
+static_assert(sizeof(TelemetryFileHeader) == 512, "telemetry header layout changed");
+
+struct TelemetryCpuRecord {
+    quint32 freqKhz;            // scaling_cur_freq, 0 if offline
+    quint16 busyPermille;
+    quint8 governor;            // Index into the header's table, NO_GOVERNOR if unknown
+    quint8 flags;
+};
+
+static_assert(sizeof(TelemetryCpuRecord) == 8, "telemetry record layout changed");
+
+#endif // TELEMETRYFILE_H
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "telemetryhistory.h"
+
+#include <algorithm>
+#include <limits>
+
+TelemetryHistory::TelemetryHistory(int capacity)
+    : m_capacity(qMax(1, capacity))
+{
+}
+
+void TelemetryHistory::reset(const QList<int> &cpus, int capacity)
+{
+    m_cpus = cpus;
+    m_capacity = qMax(1, capacity);
+    m_values.assign(size_t(m_cpus.size()) * size_t(m_capacity), 0);
+    m_timestamps.assign(size_t(m_capacity), 0);
+    m_head = 0;
+    m_size = 0;
+}
+
+void TelemetryHistory::clear()
+{
+    std::fill(m_values.begin(), m_values.end(), 0);
+    std::fill(m_timestamps.begin(), m_timestamps.end(), 0);
+    m_head = 0;
+    m_size = 0;
+}
+
+bool TelemetryHistory::append(const QList<int> &values, qint64 timestampMs)
+{
+    if (m_values.empty()) {
+        return false;
+    }
+    // A tenth of the interval absorbs jitter of a timer running at the same rate
+    if (m_size > 0 && timestampMs - timestampAt(0) < SAMPLE_INTERVAL_MS - SAMPLE_INTERVAL_MS / 10) {
+        return false;
+    }
+
+    const qsizetype count = qMin(values.size(), m_cpus.size());
+    uint32_t *column = m_values.data() + m_head;
+    for (qsizetype lane = 0; lane < m_cpus.size(); ++lane) {
+        const int value = lane < count ? values.at(lane) : 0;
+        column[size_t(lane) * size_t(m_capacity)] = uint32_t(qMax(0, value));
+    }
+    m_timestamps[size_t(m_head)] = timestampMs;
+
+    m_head = (m_head + 1) % m_capacity;
+    m_size = qMin(m_size + 1, m_capacity);
+    return true;
+}
+
+int TelemetryHistory::laneOf(int cpu) const
+{
+    // Lanes follow model rows, which are in CPU order on most machines
+    if (cpu >= 0 && cpu < m_cpus.size() && m_cpus.at(cpu) == cpu) {
+        return cpu;
+    }
+    return int(m_cpus.indexOf(cpu));
+}
+
+int TelemetryHistory::slot(int age) const
+{
+    return (m_head - 1 - age + 2 * m_capacity) % m_capacity;
+}
+
+quint32 TelemetryHistory::valueAt(int lane, int age) const
+{
+    if (lane < 0 || lane >= lanes() || age < 0 || age >= m_size) {
+        return 0;
+    }
+    return m_values[size_t(lane) * size_t(m_capacity) + size_t(slot(age))];
+}
+
+qint64 TelemetryHistory::timestampAt(int age) const
+{
+    if (age < 0 || age >= m_size) {
+        return 0;
+    }
+    return m_timestamps[size_t(slot(age))];
+}
+
+int TelemetryHistory::query(int lane, Bucket *out, int buckets, qint64 windowMs) const
+{
+    if (lane < 0 || lane >= lanes() || buckets <= 0 || windowMs <= 0 || m_size == 0) {
+        return 0;
+    }
+
+    struct Accumulator {
+        quint32 min = std::numeric_limits<quint32>::max();
+        quint32 max = 0;
+        quint64 sum = 0;
+        int count = 0;
+    };
+
+    const uint32_t *values = m_values.data() + size_t(lane) * size_t(m_capacity);
+    const qint64 newest = timestampAt(0);
+    const qint64 start = newest - windowMs;
+
+    for (int bucket = 0; bucket < buckets; ++bucket) {
+        out[bucket] = Bucket();
+    }
+
+    // Newest to oldest, so the walk stops at the first sample before the window
+    Accumulator acc;
+    int current = buckets - 1;
+    auto flush = [&]() {
+        Bucket &result = out[current];
+        result.min = acc.count > 0 ? acc.min : 0;
+        result.max = acc.max;
+        result.avg = acc.count > 0 ? quint32(acc.sum / quint64(acc.count)) : 0;
+        acc = Accumulator();
+    };
+
+    for (int age = 0; age < m_size; ++age) {
+        const int index = slot(age);
+        const qint64 offset = m_timestamps[size_t(index)] - start;
+        if (offset < 0) {
+            break;
+        }
+        // The newest sample sits at offset == windowMs, in the last bucket
+        const int bucket = int(qMin<qint64>(buckets - 1, offset * buckets / windowMs));
+        if (bucket != current) {
+            flush();
+            current = bucket;
+        }
+
+        const quint32 value = values[index];
+        if (value != 0) {
+            acc.min = std::min(acc.min, value);
+            acc.max = std::max(acc.max, value);
+            acc.sum += value;
+            ++acc.count;
+        }
+    }
+    flush();
+
+    return buckets;
+}
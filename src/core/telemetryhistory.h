@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef TELEMETRYHISTORY_H
+#define TELEMETRYHISTORY_H
+
+#include <QList>
+#include <QtGlobal>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Fixed-capacity ring buffer of per-CPU samples
+ *
+ * Structure of arrays: every CPU has one contiguous lane of uint32_t values
+ * (capacity entries, lanes back to back in one allocation) plus one shared
+ * lane of timestamps. Memory is lanes * capacity * 4 bytes + capacity * 8
+ * bytes, allocated in reset() and never again; append() only stores.
+ *
+ * Samples are kept at most every SAMPLE_INTERVAL_MS, whatever the monitor
+ * rate, and buckets cover equal spans of time, so a slower rate (back-off,
+ * tray) leaves gaps instead of stretching the graph.
+ *
+ * A value of 0 means "no data" (e.g. the CPU was offline) and is skipped
+ * when buckets are computed.
+ */
+class TelemetryHistory
+{
+public:
+    struct Bucket {
+        quint32 min = 0;
+        quint32 max = 0;
+        quint32 avg = 0;
+    };
+
+    explicit TelemetryHistory(int capacity = DEFAULT_CAPACITY);
+
+    // One lane per CPU in @p cpus, in that order; drops all samples
+    void reset(const QList<int> &cpus, int capacity);
+    void reset(const QList<int> &cpus) { reset(cpus, m_capacity); }
+    void clear();
+
+    // One value per lane, in lane order; missing values are stored as 0.
+    // Skipped (returns false) if the newest sample is less than
+    // SAMPLE_INTERVAL_MS old, allowing for timer jitter.
+    bool append(const QList<int> &values, qint64 timestampMs);
+
+    int capacity() const { return m_capacity; }
+    int size() const { return m_size; }
+    int lanes() const { return int(m_cpus.size()); }
+    QList<int> cpus() const { return m_cpus; }
+    int laneOf(int cpu) const;
+
+    // Sample @p age steps back from the newest (0 = newest)
+    quint32 valueAt(int lane, int age) const;
+    qint64 timestampAt(int age) const;
+
+    // Splits the @p windowMs before the newest sample into @p buckets equal
+    // spans of time, oldest first, and writes min/max/avg of each to @p out;
+    // spans without samples are all 0. Returns @p buckets, or 0 if empty.
+    int query(int lane, Bucket *out, int buckets, qint64 windowMs = DEFAULT_WINDOW_MS) const;
+
+    static constexpr int SAMPLE_INTERVAL_MS = 500;
+    static constexpr int DEFAULT_CAPACITY = 600;
+    static constexpr qint64 DEFAULT_WINDOW_MS = qint64(DEFAULT_CAPACITY) * SAMPLE_INTERVAL_MS;  // 5 minutes
+
+private:
+    // Index in a lane of the sample @p age steps back from the newest
+    int slot(int age) const;
+
+    QList<int> m_cpus;
+    std::vector<uint32_t> m_values;         // lanes() * m_capacity
+    std::vector<qint64> m_timestamps;       // m_capacity
+    int m_capacity;
+    int m_head = 0;                         // Slot the next sample goes to
+    int m_size = 0;
+};
+
+#endif // TELEMETRYHISTORY_H
@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "telemetryreader.h"
+
+#include <QDebug>
+
+#include <cstring>
+#include <limits>
+
+TelemetryReader::TelemetryReader(const QString &path)
+    : m_file(path)
+{
+}
+
+TelemetryReader::~TelemetryReader()
+{
+    close();
+}
+
+bool TelemetryReader::open()
+{
+    if (m_header) {
+        return true;
+    }
+
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    if (size < qint64(sizeof(TelemetryFileHeader))) {
+        m_file.close();
+        return false;
+    }
+
+    uchar *map = m_file.map(0, size);
+    if (!map) {
+        m_file.close();
+        return false;
+    }
+
+    const auto *header = reinterpret_cast<const TelemetryFileHeader *>(map);
+    const bool valid = std::memcmp(header->magic, TelemetryFile::MAGIC, sizeof(header->magic)) == 0
+            && header->version == TelemetryFile::VERSION
+            && header->cpuCount > 0
+            && header->recordSize == TelemetryFile::RECORD_PREFIX_SIZE + header->cpuCount * sizeof(TelemetryCpuRecord)
+            && header->capacity > 0
+            && header->dataOffset >= sizeof(TelemetryFileHeader) + header->cpuCount * sizeof(quint32)
+            && header->dataOffset + header->capacity * header->recordSize <= quint64(size);
+
+    if (!valid) {
+        qWarning() << "Ignoring invalid telemetry file" << m_file.fileName();
+        m_file.unmap(map);
+        m_file.close();
+        return false;
+    }
+
+    m_map = map;
+    m_header = header;
+    return true;
+}
+
+void TelemetryReader::close()
+{
+    if (m_map) {
+        m_file.unmap(const_cast<uchar *>(m_map));
+        m_map = nullptr;
+        m_header = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+QList<int> TelemetryReader::cpus()
+{
+    QList<int> result;
+    if (!open()) {
+        return result;
+    }
+
+    const auto *lanes = reinterpret_cast<const quint32 *>(m_map + sizeof(TelemetryFileHeader));
+    result.reserve(m_header->cpuCount);
+    for (quint32 lane = 0; lane < m_header->cpuCount; ++lane) {
+        result.append(int(lanes[lane]));
+    }
+    return result;
+}
+
+int TelemetryReader::intervalMs()
+{
+    return open() ? int(m_header->intervalMs) : 0;
+}
+
+qint64 TelemetryReader::count()
+{
+    if (!open()) {
+        return 0;
+    }
+    return qint64(qMin(m_header->written, m_header->capacity));
+}
+
+qint64 TelemetryReader::firstTimestamp()
+{
+    return count() > 0 ? timestampAt(0) : 0;
+}
+
+qint64 TelemetryReader::lastTimestamp()
+{
+    const qint64 records = count();
+    return records > 0 ? timestampAt(records - 1) : 0;
+}
+
+QList<TelemetryReader::Sample> TelemetryReader::range(int cpu, qint64 fromMs, qint64 toMs, int maxSamples)
+{
+    QList<Sample> result;
+    const qint64 records = count();
+    const int lane = records > 0 ? laneOf(cpu) : -1;
+    if (lane < 0 || fromMs > toMs) {
+        return result;
+    }
+
+    const qint64 first = lowerBound(fromMs);
+    const qint64 end = toMs < std::numeric_limits<qint64>::max() ? lowerBound(toMs + 1) : records;
+    const qint64 matching = end - first;
+    if (matching <= 0) {
+        return result;
+    }
+
+    const qint64 stride = maxSamples > 0 ? qMax<qint64>(1, (matching + maxSamples - 1) / maxSamples) : 1;
+    result.reserve(qsizetype((matching + stride - 1) / stride));
+
+    for (qint64 index = first; index < end; index += stride) {
+        const uchar *data = record(index);
+        TelemetryCpuRecord values;
+        std::memcpy(&values, data + TelemetryFile::RECORD_PREFIX_SIZE + size_t(lane) * sizeof(TelemetryCpuRecord),
+                    sizeof(values));
+
+        Sample sample;
+        std::memcpy(&sample.wallClockMs, data, sizeof(qint64));
+        std::memcpy(&sample.timestampMs, data + TelemetryFile::STEADY_OFFSET, sizeof(qint64));
+        sample.freqKhz = int(values.freqKhz);
+        sample.busyPermille = values.busyPermille;
+        sample.online = values.flags & TelemetryFile::FLAG_ONLINE;
+        if (values.governor < m_header->governorCount && values.governor < TelemetryFile::MAX_GOVERNORS) {
+            const char *name = m_header->governors[values.governor];
+            sample.governor = QString::fromLatin1(name, qstrnlen(name, TelemetryFile::GOVERNOR_NAME_SIZE));
+        }
+        result.append(sample);
+    }
+
+    return result;
+}
+
+const uchar *TelemetryReader::record(qint64 index) const
+{
+    const quint64 records = qMin(m_header->written, m_header->capacity);
+    const quint64 slot = (m_header->written - records + quint64(index)) % m_header->capacity;
+    return m_map + m_header->dataOffset + slot * m_header->recordSize;
+}
+
+qint64 TelemetryReader::timestampAt(qint64 index) const
+{
+    qint64 timestamp;
+    std::memcpy(&timestamp, record(index) + TelemetryFile::STEADY_OFFSET, sizeof(timestamp));
+    return timestamp;
+}
+
+qint64 TelemetryReader::lowerBound(qint64 timestampMs) const
+{
+    // Steady timestamps only grow along the ring, oldest to newest; wall
+    // clock ones may not
+    qint64 low = 0;
+    qint64 high = qint64(qMin(m_header->written, m_header->capacity));
+    while (low < high) {
+        const qint64 mid = low + (high - low) / 2;
+        if (timestampAt(mid) < timestampMs) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+int TelemetryReader::laneOf(int cpu) const
+{
+    const auto *lanes = reinterpret_cast<const quint32 *>(m_map + sizeof(TelemetryFileHeader));
+    for (quint32 lane = 0; lane < m_header->cpuCount; ++lane) {
+        if (int(lanes[lane]) == cpu) {
+            return int(lane);
+        }
+    }
+    return -1;
+}
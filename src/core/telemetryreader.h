@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef TELEMETRYREADER_H
+#define TELEMETRYREADER_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#include "telemetryfile.h"
+
+/**
+ * @brief Range queries over a telemetry file written by TelemetryRecorder
+ *
+ * The file is opened on the first query and mapped read-only, so only the
+ * pages a query touches are read from disk. Records are located by binary
+ * search on their steady timestamps, which stay sorted across wall clock
+ * steps; ranges are given on that scale. A recorder appending to the same
+ * file in the same process is seen live through the shared mapping.
+ */
+class TelemetryReader
+{
+public:
+    struct Sample {
+        qint64 timestampMs = 0;     // Steady, see TelemetryFile
+        qint64 wallClockMs = 0;     // As the wall clock read when sampling
+        int freqKhz = 0;
+        int busyPermille = 0;
+        QString governor;
+        bool online = false;
+    };
+
+    explicit TelemetryReader(const QString &path = TelemetryFile::defaultPath());
+    ~TelemetryReader();
+
+    TelemetryReader(const TelemetryReader &) = delete;
+    TelemetryReader &operator=(const TelemetryReader &) = delete;
+
+    QString path() const { return m_file.fileName(); }
+
+    // Opens and validates the file if needed; false if there is no usable file
+    bool open();
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    QList<int> cpus();
+    int intervalMs();
+    qint64 count();                 // Records currently held
+    qint64 firstTimestamp();        // Steady timestamps
+    qint64 lastTimestamp();
+
+    // Samples of @p cpu with fromMs <= steady timestamp <= toMs, oldest first. With
+    // @p maxSamples > 0 the range is strided down to at most that many.
+    QList<Sample> range(int cpu, qint64 fromMs, qint64 toMs, int maxSamples = 0);
+
+private:
+    const uchar *record(qint64 index) const;        // 0 = oldest
+    qint64 timestampAt(qint64 index) const;         // Steady
+    qint64 lowerBound(qint64 timestampMs) const;    // First index at or after
+    int laneOf(int cpu) const;
+
+    QFile m_file;
+    const uchar *m_map = nullptr;
+    const TelemetryFileHeader *m_header = nullptr;
+};
+
+#endif // TELEMETRYREADER_H
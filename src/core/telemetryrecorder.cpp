@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "telemetryrecorder.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+namespace {
+
+qint64 alignUp(qint64 value, qint64 alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+    close();
+}
+
+bool TelemetryRecorder::open(const QString &path, const QList<int> &cpus, int intervalMs, qint64 maxBytes)
+{
+    close();
+
+    if (cpus.isEmpty()) {
+        return false;
+    }
+
+    const quint32 recordSize =
+            quint32(TelemetryFile::RECORD_PREFIX_SIZE + size_t(cpus.size()) * sizeof(TelemetryCpuRecord));
+    const qint64 dataOffset = alignUp(qint64(sizeof(TelemetryFileHeader)) + cpus.size() * qint64(sizeof(quint32)), 64);
+    const qint64 capacity = (maxBytes - dataOffset) / recordSize;
+    if (capacity < 1) {
+        qWarning() << "Telemetry file limit too small for" << cpus.size() << "CPUs";
+        return false;
+    }
+    const qint64 fileSize = dataOffset + capacity * recordSize;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Cannot open telemetry file" << path << m_file.errorString();
+        return false;
+    }
+
+    // Continue an existing recording if it has the same shape and lane CPUs;
+    // older records would be attributed to the wrong CPUs otherwise
+    bool reuse = false;
+    if (m_file.size() == fileSize) {
+        TelemetryFileHeader existing;
+        if (m_file.read(reinterpret_cast<char *>(&existing), sizeof(existing)) == qint64(sizeof(existing))) {
+            reuse = std::memcmp(existing.magic, TelemetryFile::MAGIC, sizeof(existing.magic)) == 0
+                    && existing.version == TelemetryFile::VERSION
+                    && existing.cpuCount == quint32(cpus.size())
+                    && existing.recordSize == recordSize
+                    && existing.capacity == quint64(capacity)
+                    && existing.dataOffset == quint64(dataOffset);
+        }
+        if (reuse) {
+            QList<quint32> lanes(cpus.size());
+            const qint64 laneBytes = cpus.size() * qint64(sizeof(quint32));
+            reuse = m_file.read(reinterpret_cast<char *>(lanes.data()), laneBytes) == laneBytes;
+            for (qsizetype lane = 0; reuse && lane < cpus.size(); ++lane) {
+                reuse = lanes.at(lane) == quint32(cpus.at(lane));
+            }
+        }
+    }
+
+    if (!reuse) {
+        // Allocate the blocks now so appends never hit ENOSPC through the mapping
+        if (!m_file.resize(0) || ::posix_fallocate(m_file.handle(), 0, fileSize) != 0) {
+            if (!m_file.resize(fileSize)) {
+                qWarning() << "Cannot allocate telemetry file" << path << m_file.errorString();
+                m_file.close();
+                return false;
+            }
+        }
+    }
+
+    m_map = m_file.map(0, fileSize);
+    if (!m_map) {
+        qWarning() << "Cannot map telemetry file" << path << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_mapSize = fileSize;
+    m_header = reinterpret_cast<TelemetryFileHeader *>(m_map);
+
+    if (!reuse) {
+        std::memset(m_header, 0, sizeof(TelemetryFileHeader));
+        std::memcpy(m_header->magic, TelemetryFile::MAGIC, sizeof(m_header->magic));
+        m_header->version = TelemetryFile::VERSION;
+        m_header->headerSize = sizeof(TelemetryFileHeader);
+        m_header->cpuCount = quint32(cpus.size());
+        m_header->recordSize = recordSize;
+        m_header->capacity = quint64(capacity);
+        m_header->dataOffset = quint64(dataOffset);
+        m_header->createdMs = QDateTime::currentMSecsSinceEpoch();
+        m_header->intervalMs = quint32(qMax(0, intervalMs));
+
+        auto *lanes = reinterpret_cast<quint32 *>(m_map + sizeof(TelemetryFileHeader));
+        for (qsizetype lane = 0; lane < cpus.size(); ++lane) {
+            lanes[lane] = quint32(cpus.at(lane));
+        }
+    }
+
+    // Anchor the steady clock to the wall clock, but never behind the last
+    // record of a continued file (the clock may have been set back meanwhile)
+    const qint64 bootMs = bootTimeMs();
+    m_steadyOffsetMs = QDateTime::currentMSecsSinceEpoch() - bootMs;
+    if (m_header->written > 0) {
+        const quint64 last = (m_header->written - 1) % m_header->capacity;
+        qint64 lastSteadyMs;
+        std::memcpy(&lastSteadyMs, m_map + m_header->dataOffset + last * m_header->recordSize
+                                       + TelemetryFile::STEADY_OFFSET, sizeof(lastSteadyMs));
+        m_steadyOffsetMs = qMax(m_steadyOffsetMs, lastSteadyMs - bootMs);
+    }
+
+    m_governorIndex.clear();
+    for (quint32 i = 0; i < m_header->governorCount && i < quint32(TelemetryFile::MAX_GOVERNORS); ++i) {
+        const char *name = m_header->governors[i];
+        m_governorIndex.insert(QString::fromLatin1(name, qstrnlen(name, TelemetryFile::GOVERNOR_NAME_SIZE)),
+                               quint8(i));
+    }
+
+    qDebug() << "Recording telemetry to" << path << (reuse ? "(continued)" : "(new)")
+             << capacity << "records of" << recordSize << "bytes";
+    return true;
+}
+
+void TelemetryRecorder::close()
+{
+    if (m_map) {
+        flush();
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        m_mapSize = 0;
+        m_header = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_governorIndex.clear();
+}
+
+quint8 TelemetryRecorder::governorIndex(const QString &governor)
+{
+    if (!m_header || governor.isEmpty()) {
+        return TelemetryFile::NO_GOVERNOR;
+    }
+
+    auto it = m_governorIndex.constFind(governor);
+    if (it != m_governorIndex.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 index = m_header->governorCount;
+    if (index >= quint32(TelemetryFile::MAX_GOVERNORS)) {
+        return TelemetryFile::NO_GOVERNOR;
+    }
+
+    const QByteArray name = governor.toLatin1().left(TelemetryFile::GOVERNOR_NAME_SIZE - 1);
+    std::memset(m_header->governors[index], 0, TelemetryFile::GOVERNOR_NAME_SIZE);
+    std::memcpy(m_header->governors[index], name.constData(), size_t(name.size()));
+    m_header->governorCount = index + 1;
+    m_governorIndex.insert(governor, quint8(index));
+    return quint8(index);
+}
+
+void TelemetryRecorder::append(qint64 timestampMs, const QList<int> &freqKhz, const QList<int> &busyPermille,
+                               const QList<quint8> &governors, const QList<bool> &online)
+{
+    if (!m_header) {
+        return;
+    }
+
+    const quint64 slot = m_header->written % m_header->capacity;
+    uchar *record = m_map + m_header->dataOffset + slot * m_header->recordSize;
+    const qint64 steadyMs = bootTimeMs() + m_steadyOffsetMs;
+    std::memcpy(record, &timestampMs, sizeof(timestampMs));
+    std::memcpy(record + TelemetryFile::STEADY_OFFSET, &steadyMs, sizeof(steadyMs));
+
+    auto *cpus = reinterpret_cast<TelemetryCpuRecord *>(record + TelemetryFile::RECORD_PREFIX_SIZE);
+    for (qsizetype lane = 0; lane < qsizetype(m_header->cpuCount); ++lane) {
+        TelemetryCpuRecord &cpu = cpus[lane];
+        cpu.freqKhz = quint32(qMax(0, freqKhz.value(lane)));
+        cpu.busyPermille = quint16(qBound(0, busyPermille.value(lane), 1000));
+        cpu.governor = governors.value(lane, TelemetryFile::NO_GOVERNOR);
+        cpu.flags = online.value(lane) ? TelemetryFile::FLAG_ONLINE : 0;
+    }
+
+    // Bumped last, so a reader never sees a half written record as valid
+    m_header->written = m_header->written + 1;
+}
+
+void TelemetryRecorder::flush()
+{
+    if (m_map) {
+        ::msync(m_map, size_t(m_mapSize), MS_ASYNC);
+    }
+}
+
+qint64 TelemetryRecorder::bootTimeMs()
+{
+    // Unlike CLOCK_MONOTONIC it keeps counting during suspend, like the wall clock
+    timespec ts;
+    ::clock_gettime(CLOCK_BOOTTIME, &ts);
+    return qint64(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
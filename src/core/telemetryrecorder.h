@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef TELEMETRYRECORDER_H
+#define TELEMETRYRECORDER_H
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include "telemetryfile.h"
+
+/**
+ * @brief Appends monitor samples to a memory-mapped telemetry file
+ *
+ * open() preallocates the whole file (see TelemetryFile) and maps it, so an
+ * append is a handful of stores into the mapping; the kernel writes pages
+ * back on its own and flush() forces it. An existing file with the same
+ * lane CPUs and capacity is continued, anything else is recreated.
+ */
+class TelemetryRecorder
+{
+public:
+    TelemetryRecorder() = default;
+    ~TelemetryRecorder();
+
+    TelemetryRecorder(const TelemetryRecorder &) = delete;
+    TelemetryRecorder &operator=(const TelemetryRecorder &) = delete;
+
+    // One lane per CPU in @p cpus. The record capacity is derived from
+    // @p maxBytes, so the file never grows beyond it.
+    bool open(const QString &path, const QList<int> &cpus, int intervalMs,
+              qint64 maxBytes = DEFAULT_MAX_BYTES);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+    QString path() const { return m_file.fileName(); }
+
+    // Index of @p governor in the file's table, added on first use;
+    // TelemetryFile::NO_GOVERNOR if empty or the table is full
+    quint8 governorIndex(const QString &governor);
+
+    // Values per lane, in lane order; missing ones are recorded as 0.
+    // @p timestampMs is the wall clock, the steady timestamp is taken here.
+    void append(qint64 timestampMs, const QList<int> &freqKhz, const QList<int> &busyPermille,
+                const QList<quint8> &governors, const QList<bool> &online);
+
+    // Schedule write-back of the mapping (MS_ASYNC)
+    void flush();
+
+    static constexpr qint64 DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+private:
+    static qint64 bootTimeMs();
+
+    QFile m_file;
+    uchar *m_map = nullptr;
+    qint64 m_mapSize = 0;
+    TelemetryFileHeader *m_header = nullptr;
+    qint64 m_steadyOffsetMs = 0;    // Added to bootTimeMs() for the steady timestamp
+    QHash<QString, quint8> m_governorIndex;
+};
+
+#endif // TELEMETRYRECORDER_H
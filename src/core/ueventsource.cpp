@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "ueventsource.h"
+
+#include <QSocketNotifier>
+#include <QDebug>
+
+#include <cerrno>
+#include <cstring>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+UeventSource::UeventSource(QObject *parent)
+    : QObject(parent)
+{
+}
+
+// ============================================================================
+// Netlink
+// ============================================================================
+
+NetlinkUeventSource::NetlinkUeventSource(QObject *parent)
+    : UeventSource(parent)
+{
+}
+
+NetlinkUeventSource::~NetlinkUeventSource()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+bool NetlinkUeventSource::open()
+{
+    if (m_fd >= 0) {
+        return true;
+    }
+
+    m_fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (m_fd < 0) {
+        qWarning() << "Cannot create uevent netlink socket:" << std::strerror(errno);
+        return false;
+    }
+
+    sockaddr_nl addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_pid = 0;        // Let the kernel assign the port id
+    addr.nl_groups = 1;     // Kernel uevents (udev rebroadcasts use group 2)
+
+    if (::bind(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        qWarning() << "Cannot bind uevent netlink socket:" << std::strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &NetlinkUeventSource::onReadyRead);
+
+    return true;
+}
+
+void NetlinkUeventSource::onReadyRead()
+{
+    char buf[UEVENT_BUFFER_SIZE];
+    bool overflow = false;
+
+    // Drain everything that is queued; the notifier fires again for new data
+    for (;;) {
+        const ssize_t n = ::recv(m_fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOBUFS) {
+                // Receive queue overflowed; events were lost but the socket is fine
+                qWarning() << "uevent socket overflow, some hotplug events were dropped";
+                overflow = true;
+                continue;
+            }
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+
+        Q_EMIT ueventReceived(QByteArray(buf, static_cast<qsizetype>(n)));
+    }
+
+    // Once per drain, after the events that did arrive
+    if (overflow) {
+        Q_EMIT overflowed();
+    }
+}
+
+// ============================================================================
+// Fake
+// ============================================================================
+
+FakeUeventSource::FakeUeventSource(QObject *parent)
+    : UeventSource(parent)
+{
+}
+
+bool FakeUeventSource::open()
+{
+    m_open = true;
+    return true;
+}
+
+void FakeUeventSource::inject(const QByteArray &message)
+{
+    if (m_open) {
+        Q_EMIT ueventReceived(message);
+    }
+}
+
+void FakeUeventSource::injectCpuEvent(const QByteArray &action, int cpu)
+{
+    const QByteArray devpath = "/devices/system/cpu/cpu" + QByteArray::number(cpu);
+
+    QByteArray message;
+    message += action + '@' + devpath + '\0';
+    message += "ACTION=" + action + '\0';
+    message += "DEVPATH=" + devpath + '\0';
+    message += QByteArray("SUBSYSTEM=cpu") + '\0';
+
+    inject(message);
+}
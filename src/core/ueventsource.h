@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef UEVENTSOURCE_H
+#define UEVENTSOURCE_H
+
+#include <QObject>
+#include <QByteArray>
+
+class QSocketNotifier;
+
+/**
+ * @brief Source of raw kernel uevent messages
+ *
+ * A message is the kernel's wire format: "ACTION@DEVPATH" followed by
+ * NUL-separated KEY=VALUE pairs. HotplugMonitor consumes any source, so the
+ * netlink socket can be swapped for FakeUeventSource in tests.
+ */
+class UeventSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UeventSource(QObject *parent = nullptr);
+    ~UeventSource() override = default;
+
+    virtual bool open() = 0;
+    virtual bool isOpen() const = 0;
+
+signals:
+    void ueventReceived(const QByteArray &message);
+    // The receive queue overflowed and messages were lost; state derived
+    // from earlier events may be wrong and has to be read again
+    void overflowed();
+};
+
+/**
+ * @brief Kernel uevents from a NETLINK_KOBJECT_UEVENT socket
+ *
+ * The socket is watched by a QSocketNotifier, so there is no polling and no
+ * cost while nothing is plugged or unplugged.
+ */
+class NetlinkUeventSource : public UeventSource
+{
+    Q_OBJECT
+
+public:
+    explicit NetlinkUeventSource(QObject *parent = nullptr);
+    ~NetlinkUeventSource() override;
+
+    bool open() override;
+    bool isOpen() const override { return m_fd >= 0; }
+
+private slots:
+    void onReadyRead();
+
+private:
+    int m_fd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+
+    static constexpr int UEVENT_BUFFER_SIZE = 8192;
+};
+
+/**
+ * @brief Injectable uevent source for tests and benchmarks
+ */
+class FakeUeventSource : public UeventSource
+{
+    Q_OBJECT
+
+public:
+    explicit FakeUeventSource(QObject *parent = nullptr);
+
+    bool open() override;
+    bool isOpen() const override { return m_open; }
+
+    // Deliver a raw message as if it came from the kernel
+    void inject(const QByteArray &message);
+    // Convenience: deliver "<action>@/devices/system/cpu/cpu<N>" for the cpu subsystem
+    void injectCpuEvent(const QByteArray &action, int cpu);
+
+private:
+    bool m_open = false;
+};
+
+#endif // UEVENTSOURCE_H
@@ -12,6 +12,7 @@
 #include <KLocalizedString>
 
 #include "application.h"
+#include "core/sysfsbackend.h"
 #include "version.h"
 
 int main(int argc, char *argv[])
@@ -52,8 +53,14 @@ int main(int argc, char *argv[])
         QQuickStyle::setStyle(QStringLiteral("org.kde.desktop"));
     }
     
+    // Sysfs storage; CPUPOWER_GUI_SYSFS_ROOT points at a copied tree and
+    // CPUPOWER_GUI_FAKE_CPUS simulates a machine with that many CPUs
+    const std::unique_ptr<SysfsBackend> backend = SysfsBackend::create(
+        qEnvironmentVariable("CPUPOWER_GUI_SYSFS_ROOT"),
+        qEnvironmentVariableIntValue("CPUPOWER_GUI_FAKE_CPUS"));
+
     // Create application controller
-    Application appController;
+    Application appController(backend.get());
     
     // Set up QML engine
     QQmlApplicationEngine engine;
@@ -6,6 +6,8 @@
 #include "core/dbushelper.h"
 #include "core/sysfsreader.h"
 
+#include <algorithm>
+
 CpuListModel::CpuListModel(DbusHelper *dbus, SysfsReader *sysfs, QObject *parent)
     : QAbstractListModel(parent)
     , m_dbus(dbus)
@@ -25,12 +27,42 @@ void CpuListModel::loadCpus()
 
     qDeleteAll(m_cpuSettings);
     m_cpuSettings.clear();
+    m_currentFreqs.clear();
+    m_effectiveFreqs.clear();
+    m_busy.clear();
+    m_iowait.clear();
+    m_rowOfCpu.clear();
+
+    // One sweep for all CPUs; each CpuSettings picks up its row of the snapshot
+    const QList<CpuSnapshot> &snapshots = m_sysfs->snapshotAll();
+
+    // Group the CPUs of a policy so list sections can merge them; CPUs
+    // without cpufreq sort by their own number
+    QList<const CpuSnapshot *> ordered;
+    ordered.reserve(snapshots.size());
+    for (const CpuSnapshot &snap : snapshots) {
+        ordered.append(&snap);
+    }
+    std::stable_sort(ordered.begin(), ordered.end(), [](const CpuSnapshot *a, const CpuSnapshot *b) {
+        const int policyA = a->policy >= 0 ? a->policy : a->cpu;
+        const int policyB = b->policy >= 0 ? b->policy : b->cpu;
+        return policyA != policyB ? policyA < policyB : a->cpu < b->cpu;
+    });
+
+    for (const CpuSnapshot *snapPtr : std::as_const(ordered)) {
+        const CpuSnapshot &snap = *snapPtr;
+        if (snap.cpu >= m_rowOfCpu.size()) {
+            m_rowOfCpu.resize(snap.cpu + 1, -1);
+        }
+        m_rowOfCpu[snap.cpu] = int(m_cpuSettings.size());
 
-    const QList<int> cpus = m_sysfs->availableCpus();
-    for (int cpu : cpus) {
-        auto *settings = new CpuSettings(cpu, m_dbus, m_sysfs, this);
+        auto *settings = new CpuSettings(snap.cpu, m_dbus, m_sysfs, this);
         connectCpuSignals(settings);
         m_cpuSettings.append(settings);
+        m_currentFreqs.append(m_sysfs->currentFreq(snap.cpu));
+        m_effectiveFreqs.append(EffectiveFreq());
+        m_busy.append(0);
+        m_iowait.append(0);
     }
 
     endResetModel();
@@ -90,11 +122,21 @@ QVariant CpuListModel::data(const QModelIndex &index, int role) const
     case GovernorRole:
         return cpu->governor();
     case CurrentFreqRole:
-        return cpu->currentFreq();
+        return m_currentFreqs.at(index.row()) / 1000.0;
+    case EffectiveFreqRole:
+        return m_effectiveFreqs.at(index.row()).avgKhz / 1000.0;
+    case C0ResidencyRole:
+        return m_effectiveFreqs.at(index.row()).c0Residency * 100.0;
+    case UtilizationRole:
+        return m_busy.at(index.row()) / 10.0;
+    case IowaitRole:
+        return m_iowait.at(index.row()) / 10.0;
     case ChangedRole:
         return cpu->isChanged();
     case SettingsRole:
         return QVariant::fromValue(cpu);
+    case PolicyRole:
+        return m_sysfs->policyOf(cpu->cpu());
     default:
         return QVariant();
     }
@@ -141,7 +183,12 @@ QHash<int, QByteArray> CpuListModel::roleNames() const
         {GovernorRole, "governor"},
         {CurrentFreqRole, "currentFreq"},
         {ChangedRole, "changed"},
-        {SettingsRole, "settings"}
+        {SettingsRole, "settings"},
+        {PolicyRole, "policy"},
+        {EffectiveFreqRole, "effectiveFreq"},
+        {C0ResidencyRole, "c0Residency"},
+        {UtilizationRole, "utilization"},
+        {IowaitRole, "iowait"}
     };
 }
 
@@ -180,6 +227,11 @@ bool CpuListModel::hasChanges() const
     return false;
 }
 
+bool CpuListModel::sharedPolicies() const
+{
+    return m_sysfs->hasSharedPolicies();
+}
+
 CpuSettings* CpuListModel::cpuAt(int index) const
 {
     if (index >= 0 && index < m_cpuSettings.count()) {
@@ -188,6 +240,16 @@ CpuSettings* CpuListModel::cpuAt(int index) const
     return nullptr;
 }
 
+QList<int> CpuListModel::rowCpus() const
+{
+    QList<int> cpus;
+    cpus.reserve(m_cpuSettings.size());
+    for (const auto *cpu : m_cpuSettings) {
+        cpus.append(cpu->cpu());
+    }
+    return cpus;
+}
+
 void CpuListModel::refresh()
 {
     if (m_currentIndex >= 0 && m_currentIndex < m_cpuSettings.count()) {
@@ -197,11 +259,34 @@ void CpuListModel::refresh()
 
 void CpuListModel::refreshAll()
 {
+    m_sysfs->snapshotAll();
+
     for (auto *cpu : m_cpuSettings) {
-        cpu->updateFromSystem();
+        const CpuSnapshot *snap = m_sysfs->lastSnapshot(cpu->cpu());
+        if (snap) {
+            cpu->updateFromSnapshot(*snap);
+        }
+    }
+}
+
+void CpuListModel::refreshCpu(int cpu)
+{
+    const int row = rowForCpu(cpu);
+    if (row >= 0) {
+        m_cpuSettings.at(row)->updateFromSystem();
     }
 }
 
+void CpuListModel::reload()
+{
+    loadCpus();
+}
+
+int CpuListModel::rowForCpu(int cpu) const
+{
+    return cpu >= 0 && cpu < m_rowOfCpu.size() ? m_rowOfCpu.at(cpu) : -1;
+}
+
 void CpuListModel::resetAll()
 {
     for (auto *cpu : m_cpuSettings) {
@@ -226,13 +311,114 @@ int CpuListModel::applyAll()
     return result;
 }
 
-void CpuListModel::updateCurrentFrequencies()
+bool CpuListModel::setCurrentFrequencies(const QList<int> &khzByRow)
 {
-    // Update current frequency for display (called by timer)
-    for (int i = 0; i < m_cpuSettings.count(); ++i) {
-        QModelIndex idx = index(i);
-        Q_EMIT dataChanged(idx, idx, {CurrentFreqRole});
+    const int rows = int(qMin(khzByRow.size(), m_currentFreqs.size()));
+    int first = -1;
+    int last = -1;
+
+    for (int row = 0; row < rows; ++row) {
+        const int khz = khzByRow.at(row);
+        if (qAbs(khz - m_currentFreqs.at(row)) < FREQ_CHANGE_THRESHOLD_KHZ) {
+            continue;
+        }
+
+        m_currentFreqs[row] = khz;
+        if (first < 0) {
+            first = row;
+        }
+        last = row;
+    }
+
+    // One notification for the whole tick instead of one per row
+    if (first < 0) {
+        return false;
+    }
+
+    Q_EMIT dataChanged(index(first), index(last), {CurrentFreqRole});
+    return true;
+}
+
+bool CpuListModel::setLoad(const QList<int> &busyPermille, const QList<int> &iowaitPermille)
+{
+    const int rows = int(qMin(qMin(busyPermille.size(), iowaitPermille.size()), m_busy.size()));
+    int first = -1;
+    int last = -1;
+
+    for (int row = 0; row < rows; ++row) {
+        const int busy = busyPermille.at(row);
+        const int iowait = iowaitPermille.at(row);
+        if (qAbs(busy - m_busy.at(row)) < LOAD_CHANGE_THRESHOLD_PERMILLE
+                && qAbs(iowait - m_iowait.at(row)) < LOAD_CHANGE_THRESHOLD_PERMILLE) {
+            continue;
+        }
+
+        m_busy[row] = busy;
+        m_iowait[row] = iowait;
+        if (first < 0) {
+            first = row;
+        }
+        last = row;
+    }
+
+    if (first < 0) {
+        return false;
+    }
+
+    Q_EMIT dataChanged(index(first), index(last), {UtilizationRole, IowaitRole});
+    return true;
+}
+
+void CpuListModel::setEffectiveFrequencies(const QList<EffectiveFreq> &freqs)
+{
+    QList<EffectiveFreq> byRow(m_effectiveFreqs.size());
+    for (const EffectiveFreq &freq : freqs) {
+        const int row = rowForCpu(freq.cpu);
+        if (row >= 0) {
+            byRow[row] = freq;
+        }
+    }
+
+    int first = -1;
+    int last = -1;
+    for (int row = 0; row < byRow.size(); ++row) {
+        const EffectiveFreq &old = m_effectiveFreqs.at(row);
+        const EffectiveFreq &freq = byRow.at(row);
+        if (old.cpu == freq.cpu
+                && qAbs(freq.avgKhz - old.avgKhz) < FREQ_CHANGE_THRESHOLD_KHZ
+                && qAbs(freq.c0Residency - old.c0Residency) < C0_CHANGE_THRESHOLD) {
+            continue;
+        }
+
+        m_effectiveFreqs[row] = freq;
+        if (first < 0) {
+            first = row;
+        }
+        last = row;
+    }
+
+    if (first >= 0) {
+        Q_EMIT dataChanged(index(first), index(last), {EffectiveFreqRole, C0ResidencyRole});
+    }
+
+    if (!freqs.isEmpty() && !m_hasEffectiveFreqs) {
+        m_hasEffectiveFreqs = true;
+        Q_EMIT hasEffectiveFrequenciesChanged();
+    }
+}
+
+void CpuListModel::clearEffectiveFrequencies()
+{
+    if (!m_hasEffectiveFreqs) {
+        return;
+    }
+
+    m_effectiveFreqs.fill(EffectiveFreq());
+    if (!m_effectiveFreqs.isEmpty()) {
+        Q_EMIT dataChanged(index(0), index(int(m_effectiveFreqs.size()) - 1), {EffectiveFreqRole, C0ResidencyRole});
     }
+    m_hasEffectiveFreqs = false;
+    Q_EMIT hasEffectiveFrequenciesChanged();
 }
 
 void CpuListModel::copyCurrentToAll()
@@ -8,6 +8,8 @@
 #include <QList>
 #include <QPointer>
 
+#include "core/helperprotocol.h"
+
 class CpuSettings;
 class DbusHelper;
 class SysfsReader;
@@ -27,6 +29,8 @@ class CpuListModel : public QAbstractListModel
     Q_PROPERTY(CpuSettings* currentCpu READ currentCpu NOTIFY currentCpuChanged)
     Q_PROPERTY(bool applyToAll READ applyToAll WRITE setApplyToAll NOTIFY applyToAllChanged)
     Q_PROPERTY(bool hasChanges READ hasChanges NOTIFY hasChangesChanged)
+    Q_PROPERTY(bool sharedPolicies READ sharedPolicies NOTIFY countChanged)
+    Q_PROPERTY(bool hasEffectiveFrequencies READ hasEffectiveFrequencies NOTIFY hasEffectiveFrequenciesChanged)
 
 public:
     enum Roles {
@@ -37,7 +41,12 @@ public:
         GovernorRole,
         CurrentFreqRole,
         ChangedRole,
-        SettingsRole  // Returns CpuSettings* for direct access
+        SettingsRole,  // Returns CpuSettings* for direct access
+        PolicyRole,    // cpufreq policy the CPU belongs to
+        EffectiveFreqRole,  // MHz delivered (APERF/MPERF), 0 if not measured
+        C0ResidencyRole,    // Percent of the window spent in C0
+        UtilizationRole,    // Percent busy since the previous sample (/proc/stat)
+        IowaitRole          // Percent waiting for I/O since the previous sample
     };
 
     explicit CpuListModel(DbusHelper *dbus, SysfsReader *sysfs, QObject *parent = nullptr);
@@ -58,14 +67,43 @@ public:
     bool applyToAll() const { return m_applyToAll; }
     void setApplyToAll(bool apply);
     bool hasChanges() const;
+    // True if some CPUs share a cpufreq policy (rows are then grouped by policy)
+    bool sharedPolicies() const;
 
     // Actions
     Q_INVOKABLE CpuSettings* cpuAt(int index) const;
+    // Rows are ordered by (policy, CPU) so that CPUs of one policy are
+    // adjacent (SMT siblings often are not); -1 if @p cpu has no row
+    Q_INVOKABLE int rowForCpu(int cpu) const;
+    QList<int> rowCpus() const;             // CPU number of each row, in row order
     Q_INVOKABLE void refresh();
     Q_INVOKABLE void refreshAll();
+    Q_INVOKABLE void refreshCpu(int cpu);    // Re-read a single CPU's row (e.g. after hotplug)
+    Q_INVOKABLE void reload();               // Rebuild all rows (the set of CPUs changed)
     Q_INVOKABLE void resetAll();
     Q_INVOKABLE int applyAll();
-    Q_INVOKABLE void updateCurrentFrequencies();
+    // Publish a sample taken elsewhere: kHz per row, in row order. Emits one
+    // dataChanged for CurrentFreqRole spanning the rows that moved by at least
+    // FREQ_CHANGE_THRESHOLD_KHZ; other rows keep their cached value.
+    // Returns true if any row changed.
+    bool setCurrentFrequencies(const QList<int> &khzByRow);
+
+    static constexpr int FREQ_CHANGE_THRESHOLD_KHZ = 1000;  // Display resolution is 1 MHz
+    static constexpr double C0_CHANGE_THRESHOLD = 0.01;     // Shown as whole percent
+
+    // Publish busy/iowait shares (per mille per row, in row order). Emits one
+    // dataChanged spanning the rows that moved by LOAD_CHANGE_THRESHOLD_PERMILLE.
+    // Returns true if any row changed.
+    bool setLoad(const QList<int> &busyPermille, const QList<int> &iowaitPermille);
+
+    static constexpr int LOAD_CHANGE_THRESHOLD_PERMILLE = 10;   // Shown as whole percent
+
+    // Publish a get_effective_freqs() result; CPUs missing from it show as
+    // not measured. Emits one dataChanged spanning the rows that changed.
+    void setEffectiveFrequencies(const QList<EffectiveFreq> &freqs);
+    // Forget all measurements and hide the column again
+    void clearEffectiveFrequencies();
+    bool hasEffectiveFrequencies() const { return m_hasEffectiveFreqs; }
 
     // Copy settings from current CPU to all others
     Q_INVOKABLE void copyCurrentToAll();
@@ -76,6 +114,7 @@ signals:
     void currentCpuChanged();
     void applyToAllChanged();
     void hasChangesChanged();
+    void hasEffectiveFrequenciesChanged();
     void errorOccurred(const QString &error);
 
 private slots:
@@ -88,6 +127,15 @@ private:
     DbusHelper *m_dbus;
     SysfsReader *m_sysfs;
     QList<CpuSettings*> m_cpuSettings;
+    // Last published scaling_cur_freq per row (kHz); data() never reads sysfs for it
+    QList<int> m_currentFreqs;
+    QList<int> m_rowOfCpu;          // CPU number -> row, -1 if none
+    // Last published load per row, per mille
+    QList<int> m_busy;
+    QList<int> m_iowait;
+    // Last get_effective_freqs() result per row (cpu == -1 if not measured)
+    QList<EffectiveFreq> m_effectiveFreqs;
+    bool m_hasEffectiveFreqs = false;
     int m_currentIndex = 0;
     bool m_applyToAll = false;
 };
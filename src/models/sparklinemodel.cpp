@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#include "sparklinemodel.h"
+
+SparklineModel::SparklineModel(const TelemetryHistory *history, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_history(history)
+    , m_buckets(size_t(DEFAULT_BUCKETS))
+{
+}
+
+int SparklineModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_count;
+}
+
+QVariant SparklineModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_count) {
+        return {};
+    }
+
+    const TelemetryHistory::Bucket &bucket = m_buckets[size_t(index.row())];
+
+    switch (role) {
+    case MinRole:
+        return bucket.min / 1000.0;
+    case MaxRole:
+        return bucket.max / 1000.0;
+    case Qt::DisplayRole:
+    case AvgRole:
+        return bucket.avg / 1000.0;
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> SparklineModel::roleNames() const
+{
+    return {
+        {MinRole, "min"},
+        {MaxRole, "max"},
+        {AvgRole, "avg"}
+    };
+}
+
+void SparklineModel::setCpu(int cpu)
+{
+    if (m_cpu == cpu) {
+        return;
+    }
+    m_cpu = cpu;
+    Q_EMIT cpuChanged();
+    refresh();
+}
+
+void SparklineModel::setBucketCount(int count)
+{
+    count = qMax(1, count);
+    if (m_bucketCount == count) {
+        return;
+    }
+    m_bucketCount = count;
+    m_buckets.resize(size_t(count));
+    Q_EMIT bucketCountChanged();
+    refresh();
+}
+
+void SparklineModel::refresh()
+{
+    const int lane = m_history->laneOf(m_cpu);
+    const int count = m_history->query(lane, m_buckets.data(), m_bucketCount, TelemetryHistory::DEFAULT_WINDOW_MS);
+
+    m_peak = 0;
+    for (int i = 0; i < count; ++i) {
+        m_peak = qMax(m_peak, m_buckets[size_t(i)].max);
+    }
+    m_spanMs = m_history->size() > 1
+            ? qMin(TelemetryHistory::DEFAULT_WINDOW_MS,
+                   m_history->timestampAt(0) - m_history->timestampAt(m_history->size() - 1))
+            : 0;
+
+    // The bucket count only changes when the history empties or fills
+    if (count != m_count) {
+        beginResetModel();
+        m_count = count;
+        endResetModel();
+        Q_EMIT countChanged();
+    } else if (count > 0) {
+        Q_EMIT dataChanged(index(0), index(count - 1), {MinRole, MaxRole, AvgRole});
+    }
+
+    Q_EMIT refreshed();
+}
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2024 cpupower-gui contributors
+
+#ifndef SPARKLINEMODEL_H
+#define SPARKLINEMODEL_H
+
+#include <QAbstractListModel>
+
+#include <vector>
+
+#include "core/telemetryhistory.h"
+
+/**
+ * @brief Decimated frequency history of one CPU for a QML sparkline
+ *
+ * One row per bucket of equal time over the last
+ * TelemetryHistory::DEFAULT_WINDOW_MS, oldest first, with min/max/avg in MHz
+ * (all 0 where there was no sample). refresh()
+ * re-queries the history into a buffer sized by bucketCount, so redrawing
+ * after every sample does not allocate.
+ */
+class SparklineModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int cpu READ cpu WRITE setCpu NOTIFY cpuChanged)
+    Q_PROPERTY(int bucketCount READ bucketCount WRITE setBucketCount NOTIFY bucketCountChanged)
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(double peak READ peak NOTIFY refreshed)              // Highest max in MHz
+    Q_PROPERTY(double spanSeconds READ spanSeconds NOTIFY refreshed) // Time covered
+
+public:
+    enum Roles {
+        MinRole = Qt::UserRole + 1,
+        MaxRole,
+        AvgRole
+    };
+
+    // @p history must outlive the model
+    explicit SparklineModel(const TelemetryHistory *history, QObject *parent = nullptr);
+    ~SparklineModel() override = default;
+
+    // QAbstractListModel interface
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int cpu() const { return m_cpu; }
+    void setCpu(int cpu);
+    int bucketCount() const { return m_bucketCount; }
+    void setBucketCount(int count);
+    double peak() const { return m_peak / 1000.0; }
+    double spanSeconds() const { return m_spanMs / 1000.0; }
+
+    // Re-read the history (call after appending samples)
+    Q_INVOKABLE void refresh();
+
+    static constexpr int DEFAULT_BUCKETS = 60;
+
+signals:
+    void cpuChanged();
+    void bucketCountChanged();
+    void countChanged();
+    void refreshed();
+
+private:
+    const TelemetryHistory *m_history;
+    std::vector<TelemetryHistory::Bucket> m_buckets;
+    int m_cpu = 0;
+    int m_bucketCount = DEFAULT_BUCKETS;
+    int m_count = 0;
+    quint32 m_peak = 0;     // kHz
+    qint64 m_spanMs = 0;
+};
+
+#endif // SPARKLINEMODEL_H
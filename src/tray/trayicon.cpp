@@ -55,6 +55,13 @@ void TrayIcon::setProfileManager(ProfileManager *manager)
     updateMenu();
 }
 
+void TrayIcon::setStatusText(const QString &text)
+{
+    if (m_sni && m_sni->toolTipSubTitle() != text) {
+        m_sni->setToolTipSubTitle(text);
+    }
+}
+
 void TrayIcon::updateMenu()
 {
     if (!m_sni) {
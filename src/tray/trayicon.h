@@ -32,6 +32,8 @@ public:
     void setVisible(bool visible);
 
     void setProfileManager(ProfileManager *manager);
+    // Second line of the tooltip (e.g. live frequency summary)
+    void setStatusText(const QString &text);
 
 public slots:
     void updateMenu();